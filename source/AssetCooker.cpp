@@ -0,0 +1,238 @@
+#include "pch.h"
+
+#undef main
+#include "Assets.h"
+#include "AssetLoader.h"
+#include "Utils.h"
+#include <filesystem>
+#include <functional>
+
+//the asset cooker makes the cache files of the renderer ahead of time, so the renderer maps them at startup instead of
+//parsing the obj files and encoding the textures: welded and tangent vertices, cache optimized indices, meshlets,
+//levels of detail and bounds for the meshes, mip levels in the tiled or block compressed layout for the textures
+//the files are named after the sources and the settings, so an asset whose cache file exists is up to date and skipped
+//usage: AssetCooker [--force] [--parts=maxVerticesPerPart] [model.obj | image.png ...]
+//without files it cooks the assets the renderer loads (Assets.h), files get the default settings of Mesh and Texture
+//with --parts the obj files after it are parsed one part at a time and every part gets its own cache file, for models that don't fit in memory
+//this only cooks them in parts, there is no loader for the part caches yet
+
+using namespace dae;
+
+namespace
+{
+	//only the constructor of the mesh is used, it parses, optimizes and caches the model
+	class CookingMesh final : public Mesh
+	{
+	public:
+		CookingMesh(const std::string& modelFilePath, VertexFormat vertexFormat, bool keepTriangleOrder)
+			: Mesh(nullptr, modelFilePath, 0.f, 0.f, vertexFormat, keepTriangleOrder)
+		{
+		}
+
+		CookingMesh(const std::string& modelName, std::vector<Vertex_In>&& vertices, std::vector<uint32_t>&& indices, const std::string& cachePath, VertexFormat vertexFormat, bool keepTriangleOrder)
+			: Mesh(nullptr, modelName, std::move(vertices), std::move(indices), cachePath, 0.f, 0.f, vertexFormat, keepTriangleOrder)
+		{
+		}
+
+		void RenderHardware(ID3D11DeviceContext* pDeviceContext) const override {}
+
+	private:
+		void BinTriangles(SoftwareFrame& frame) override {}
+		void RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels, const Vector2& tileMin, const Vector2& tileMax) const override {}
+		void RenderPixel(uint32_t pixelIndex, const Vertex_Out& triangleVertex0, const Vertex_Out& triangleVertex1, const Vertex_Out& triangleVertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const override {}
+		ColorRGBA ShadePixel(const Vertex_Out& vertex, const UVDerivatives& uvDerivatives) const override { return {}; }
+	};
+
+	enum class CookResult
+	{
+		cooked,
+		upToDate,
+		failed
+	};
+
+	struct CookReport
+	{
+		std::string name;
+		std::string cachePath;
+		CookResult result;
+		double milliseconds;
+	};
+
+	struct CookJob
+	{
+		std::string name;
+		//empty when a source can't be opened
+		std::string cachePath;
+		//makes the cache file, a mesh or texture that loads without its cache file saves it
+		std::function<void()> cook;
+	};
+
+	CookReport RunCookJob(const CookJob& job, bool force)
+	{
+		if (job.cachePath.empty())
+			return { job.name, job.cachePath, CookResult::failed, 0.0 };
+
+		std::error_code error{};
+
+		if (force)
+			std::filesystem::remove(job.cachePath, error);
+		else if (std::filesystem::exists(job.cachePath, error))
+			return { job.name, job.cachePath, CookResult::upToDate, 0.0 };
+
+		const uint64_t startTicks{ SDL_GetPerformanceCounter() };
+		job.cook();
+		const double milliseconds{ (SDL_GetPerformanceCounter() - startTicks) * 1000.0 / SDL_GetPerformanceFrequency() };
+
+		return { job.name, job.cachePath, std::filesystem::exists(job.cachePath, error) ? CookResult::cooked : CookResult::failed, milliseconds };
+	}
+
+	CookJob CreateMeshJob(const std::string& modelFilePath, Mesh::VertexFormat vertexFormat, bool keepTriangleOrder)
+	{
+		return
+		{
+			modelFilePath,
+			Mesh::GetCachePath(modelFilePath, vertexFormat, keepTriangleOrder),
+			[=] { delete new CookingMesh(modelFilePath, vertexFormat, keepTriangleOrder); }
+		};
+	}
+
+	//the cache path of the job is the part list, so the model is only up to date when every part was cooked
+	CookJob CreatePartedMeshJob(const std::string& modelFilePath, Mesh::VertexFormat vertexFormat, bool keepTriangleOrder, uint32_t maxVerticesPerPart)
+	{
+		const std::string partListPath{ Mesh::GetPartListPath(modelFilePath, vertexFormat, keepTriangleOrder, maxVerticesPerPart) };
+
+		const auto cook = [=]
+		{
+			std::vector<std::string> partCachePaths{};
+
+			const bool isParsed{ Utils::ParseOBJInParts(modelFilePath, maxVerticesPerPart, [&](std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices)
+			{
+				const uint32_t part{ static_cast<uint32_t>(partCachePaths.size()) };
+				partCachePaths.push_back(Mesh::GetPartCachePath(partListPath, part));
+
+				delete new CookingMesh(modelFilePath + " part " + std::to_string(part), std::move(vertices), std::move(indices), partCachePaths.back(), vertexFormat, keepTriangleOrder);
+			}) };
+
+			if (!isParsed)
+				return;
+
+			Utils::WriteCacheFile(partListPath, [&](std::ofstream& file)
+			{
+				for (const std::string& partCachePath : partCachePaths)
+				{
+					file << partCachePath << '\n';
+				}
+			});
+		};
+
+		return { modelFilePath, partListPath, cook };
+	}
+
+	CookJob CreateTextureJob(const std::string& path, Texture::Format format)
+	{
+		return
+		{
+			path,
+			Texture::GetCachePath(path, format),
+			[=] { delete Texture::LoadFromFile(path, nullptr, format); }
+		};
+	}
+
+	CookJob CreatePackedTextureJob(const std::array<Texture::ChannelSource, 4>& channelSources, Texture::Format format)
+	{
+		std::string name{};
+
+		for (const Texture::ChannelSource& channelSource : channelSources)
+		{
+			name += (name.empty() ? "" : " + ") + channelSource.path;
+		}
+
+		return
+		{
+			name,
+			Texture::GetPackedCachePath(channelSources, format),
+			[=] { delete Texture::LoadPackedFromFiles(channelSources, nullptr, format); }
+		};
+	}
+}
+
+int main(int argc, char* args[])
+{
+	bool force{ false };
+	uint32_t maxVerticesPerPart{};
+	std::vector<CookJob> jobs{};
+
+	for (int index{ 1 }; index < argc; ++index)
+	{
+		const std::string argument{ args[index] };
+		const std::string extension{ std::filesystem::path{ argument }.extension().string() };
+
+		if (argument == "--force")
+			force = true;
+		else if (argument.starts_with("--parts="))
+			maxVerticesPerPart = static_cast<uint32_t>(std::strtoul(argument.c_str() + std::strlen("--parts="), nullptr, 10));
+		else if (extension == ".obj" && maxVerticesPerPart > 0)
+			jobs.push_back(CreatePartedMeshJob(argument, Mesh::VertexFormat::full, false, maxVerticesPerPart));
+		else if (extension == ".obj")
+			jobs.push_back(CreateMeshJob(argument, Mesh::VertexFormat::full, false));
+		else if (extension == ".png")
+			jobs.push_back(CreateTextureJob(argument, Texture::Format::rgba8));
+		else
+			std::cout << "Skipping " << argument << ", only obj and png files can be cooked\n";
+	}
+
+	if (jobs.empty())
+	{
+		for (const Assets::MeshSource* pMeshSource : Assets::meshes)
+		{
+			jobs.push_back(CreateMeshJob(pMeshSource->modelFilePath, pMeshSource->vertexFormat, pMeshSource->keepTriangleOrder));
+		}
+
+		for (const Assets::TextureSource* pTextureSource : Assets::textures)
+		{
+			jobs.push_back(CreateTextureJob(pTextureSource->path, pTextureSource->format));
+		}
+
+		for (const Assets::PackedTextureSource* pPackedTextureSource : Assets::packedTextures)
+		{
+			jobs.push_back(CreatePackedTextureJob(pPackedTextureSource->channelSources, pPackedTextureSource->format));
+		}
+	}
+
+	//every asset is cooked on its own loader thread, the reports are printed in the order of the jobs
+	const uint64_t startTicks{ SDL_GetPerformanceCounter() };
+	AssetLoader assetLoader{};
+	std::vector<std::future<CookReport*>> reports{};
+
+	for (const CookJob& job : jobs)
+	{
+		reports.push_back(assetLoader.Load<CookReport>([&job, force] { return new CookReport{ RunCookJob(job, force) }; }));
+	}
+
+	int amountOfFailedJobs{};
+
+	for (std::future<CookReport*>& futureReport : reports)
+	{
+		const std::unique_ptr<CookReport> pReport{ futureReport.get() };
+
+		switch (pReport->result)
+		{
+		case CookResult::cooked:
+			std::cout << "Cooked " << pReport->name << " in " << pReport->milliseconds << " ms -> " << pReport->cachePath << '\n';
+			break;
+
+		case CookResult::upToDate:
+			std::cout << pReport->name << " is up to date\n";
+			break;
+
+		case CookResult::failed:
+			std::cout << "Failed to cook " << pReport->name << '\n';
+			++amountOfFailedJobs;
+			break;
+		}
+	}
+
+	std::cout << jobs.size() << " assets in " << (SDL_GetPerformanceCounter() - startTicks) * 1000.0 / SDL_GetPerformanceFrequency() << " ms, " << amountOfFailedJobs << " failed\n";
+
+	return amountOfFailedJobs > 0 ? 1 : 0;
+}
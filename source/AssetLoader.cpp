@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "AssetLoader.h"
+
+namespace dae
+{
+	AssetLoader::AssetLoader(uint32_t amountOfThreads)
+	{
+		for (uint32_t workerIndex{}; workerIndex < std::max(amountOfThreads, 1u); ++workerIndex)
+		{
+			m_Workers.emplace_back(&AssetLoader::WorkerLoop, this);
+		}
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		//the jobs that are still queued are finished first, their futures would never be ready otherwise
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_IsShuttingDown = true;
+		}
+
+		m_JobAvailableCondition.notify_all();
+
+		for (std::thread& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	void AssetLoader::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job{};
+
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_JobAvailableCondition.wait(lock, [this] { return m_IsShuttingDown || !m_Jobs.empty(); });
+
+				if (m_Jobs.empty())
+					return;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+
+			job();
+		}
+	}
+}
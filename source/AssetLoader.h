@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+namespace dae
+{
+	//runs loading jobs on its own threads, every job returns a future that holds the loaded asset once it is done
+	//unlike the ThreadPool the caller doesn't wait, so slow assets (an obj file, an effect) load while others are decoded
+	class AssetLoader final
+	{
+	public:
+		AssetLoader(uint32_t amountOfThreads = std::thread::hardware_concurrency());
+		~AssetLoader();
+
+		AssetLoader(const AssetLoader& other) = delete;
+		AssetLoader(AssetLoader&& other) = delete;
+		AssetLoader& operator=(const AssetLoader& other) = delete;
+		AssetLoader& operator=(AssetLoader&& other) = delete;
+
+		//the job runs on one of the loader threads, so everything it touches has to be safe to use from there
+		//(the D3D11 device is, the device context is not)
+		template<typename Asset>
+		std::future<Asset*> Load(const std::function<Asset*()>& job)
+		{
+			std::shared_ptr<std::packaged_task<Asset*()>> pTask{ std::make_shared<std::packaged_task<Asset*()>>(job) };
+			std::future<Asset*> asset{ pTask->get_future() };
+
+			{
+				std::lock_guard lock{ m_Mutex };
+				m_Jobs.emplace_back([pTask] { (*pTask)(); });
+			}
+
+			m_JobAvailableCondition.notify_one();
+			return asset;
+		}
+
+	private:
+		std::vector<std::thread> m_Workers;
+		std::deque<std::function<void()>> m_Jobs;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_JobAvailableCondition;
+		bool m_IsShuttingDown{};
+
+		void WorkerLoop();
+	};
+}
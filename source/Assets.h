@@ -0,0 +1,57 @@
+#pragma once
+#include "pch.h"
+#include "Mesh.h"
+#include "Texture.h"
+#include <array>
+
+namespace dae
+{
+	//the source files the renderer loads and the settings it loads them with
+	//the cache files are named after both, so the asset cooker uses this list to make the same files ahead of time
+	namespace Assets
+	{
+		struct MeshSource
+		{
+			const char* modelFilePath;
+			Mesh::VertexFormat vertexFormat;
+			bool keepTriangleOrder;
+		};
+
+		struct TextureSource
+		{
+			const char* path;
+			Texture::Format format;
+		};
+
+		struct PackedTextureSource
+		{
+			std::array<Texture::ChannelSource, 4> channelSources;
+			Texture::Format format;
+		};
+
+		//the PartialCoverageMesh always keeps the full vertices in the order of the file
+		inline const MeshSource fireFXMesh{ "Resources/fireFX.obj", Mesh::VertexFormat::full, true };
+		//the vehicle is the large model, its vertices are stored compact
+		inline const MeshSource vehicleMesh{ "Resources/vehicle.obj", Mesh::VertexFormat::compact, false };
+
+		inline const TextureSource fireFXDiffuse{ "Resources/fireFX_diffuse.png", Texture::Format::bc3 };
+		inline const TextureSource vehicleDiffuse{ "Resources/vehicle_diffuse.png", Texture::Format::bc1 };
+		//no block format below BC7 holds four independent channels, so the material map stays uncompressed
+		//the specular map is close to grey, only its red channel is kept
+		inline const PackedTextureSource vehicleMaterial
+		{
+			{
+				Texture::ChannelSource{ "Resources/vehicle_normal.png", 0 },
+				Texture::ChannelSource{ "Resources/vehicle_normal.png", 1 },
+				Texture::ChannelSource{ "Resources/vehicle_specular.png", 0 },
+				Texture::ChannelSource{ "Resources/vehicle_gloss.png", 0 }
+			},
+			Texture::Format::rgba8
+		};
+
+		//everything above, new assets have to be added here too
+		inline const std::array<const MeshSource*, 2> meshes{ &fireFXMesh, &vehicleMesh };
+		inline const std::array<const TextureSource*, 2> textures{ &fireFXDiffuse, &vehicleDiffuse };
+		inline const std::array<const PackedTextureSource*, 1> packedTextures{ &vehicleMaterial };
+	}
+}
@@ -0,0 +1,325 @@
+#include "pch.h"
+#include "BlockCompression.h"
+#include <climits>
+#include <cstring>
+
+namespace dae
+{
+	namespace BlockCompression
+	{
+		namespace
+		{
+			uint8_t GetChannel(uint32_t texel, int channel)
+			{
+				return static_cast<uint8_t>(texel >> (8 * channel));
+			}
+
+			uint16_t PackRGB565(const int color[3])
+			{
+				const int r{ (color[0] * 31 + 127) / 255 };
+				const int g{ (color[1] * 63 + 127) / 255 };
+				const int b{ (color[2] * 31 + 127) / 255 };
+
+				return static_cast<uint16_t>(r << 11 | g << 5 | b);
+			}
+
+			void UnpackRGB565(uint16_t packedColor, int color[3])
+			{
+				const int r{ packedColor >> 11 & 0x1F };
+				const int g{ packedColor >> 5 & 0x3F };
+				const int b{ packedColor & 0x1F };
+
+				//replicate the high bits in the low bits, so 0 and the maximum map to 0 and 255
+				color[0] = r << 3 | r >> 2;
+				color[1] = g << 2 | g >> 4;
+				color[2] = b << 3 | b >> 2;
+			}
+
+			void CalculateColorPalette(uint16_t color0, uint16_t color1, bool hasFourColors, uint32_t palette[4])
+			{
+				int endpoint0[3]{};
+				int endpoint1[3]{};
+				UnpackRGB565(color0, endpoint0);
+				UnpackRGB565(color1, endpoint1);
+
+				uint32_t color2{ 0xFF000000 };
+				uint32_t color3{ 0xFF000000 };
+
+				for (int channel{}; channel < 3; ++channel)
+				{
+					if (hasFourColors)
+					{
+						color2 |= static_cast<uint32_t>((2 * endpoint0[channel] + endpoint1[channel] + 1) / 3) << (8 * channel);
+						color3 |= static_cast<uint32_t>((endpoint0[channel] + 2 * endpoint1[channel] + 1) / 3) << (8 * channel);
+					}
+					else
+					{
+						color2 |= static_cast<uint32_t>((endpoint0[channel] + endpoint1[channel] + 1) / 2) << (8 * channel);
+					}
+				}
+
+				palette[0] = 0xFF000000 | endpoint0[0] | endpoint0[1] << 8 | endpoint0[2] << 16;
+				palette[1] = 0xFF000000 | endpoint1[0] | endpoint1[1] << 8 | endpoint1[2] << 16;
+				palette[2] = color2;
+				palette[3] = hasFourColors ? color3 : 0; //transparent black
+			}
+
+			int CalculateColorDistance(uint32_t texel0, uint32_t texel1)
+			{
+				int distance{};
+
+				for (int channel{}; channel < 3; ++channel)
+				{
+					const int difference{ GetChannel(texel0, channel) - GetChannel(texel1, channel) };
+					distance += difference * difference;
+				}
+
+				return distance;
+			}
+
+			//always uses the four color mode, the alpha of the texels is ignored
+			void EncodeColorBlock(const uint32_t* pTexels, uint8_t* pBlock)
+			{
+				int min[3]{ 255, 255, 255 };
+				int max[3]{};
+				int mean[3]{};
+
+				for (int index{}; index < amountOfTexelsPerBlock; ++index)
+				{
+					for (int channel{}; channel < 3; ++channel)
+					{
+						const int value{ GetChannel(pTexels[index], channel) };
+						min[channel] = std::min(min[channel], value);
+						max[channel] = std::max(max[channel], value);
+						mean[channel] += value;
+					}
+				}
+
+				//the endpoints are the corners of the bounding box along the diagonal that follows the colors best:
+				//channels that go down while the one with the largest range goes up swap their min and max
+				int referenceChannel{};
+
+				for (int channel{ 1 }; channel < 3; ++channel)
+				{
+					if (max[channel] - min[channel] > max[referenceChannel] - min[referenceChannel])
+						referenceChannel = channel;
+				}
+
+				for (int channel{}; channel < 3; ++channel)
+				{
+					mean[channel] /= amountOfTexelsPerBlock;
+				}
+
+				int endpoint0[3]{};
+				int endpoint1[3]{};
+
+				for (int channel{}; channel < 3; ++channel)
+				{
+					int covariance{};
+
+					for (int index{}; index < amountOfTexelsPerBlock; ++index)
+					{
+						covariance += (GetChannel(pTexels[index], referenceChannel) - mean[referenceChannel]) * (GetChannel(pTexels[index], channel) - mean[channel]);
+					}
+
+					//inset the box a bit, the extremes are usually outliers
+					const int inset{ (max[channel] - min[channel]) / 16 };
+
+					endpoint0[channel] = max[channel] - inset;
+					endpoint1[channel] = min[channel] + inset;
+
+					if (covariance < 0)
+						std::swap(endpoint0[channel], endpoint1[channel]);
+				}
+
+				uint16_t color0{ PackRGB565(endpoint0) };
+				uint16_t color1{ PackRGB565(endpoint1) };
+
+				//the four color mode is picked by color0 > color1
+				if (color0 < color1)
+					std::swap(color0, color1);
+
+				uint32_t indices{};
+
+				if (color0 != color1)
+				{
+					uint32_t palette[4]{};
+					CalculateColorPalette(color0, color1, true, palette);
+
+					for (int index{}; index < amountOfTexelsPerBlock; ++index)
+					{
+						uint32_t bestPaletteIndex{};
+						int bestDistance{ INT_MAX };
+
+						for (uint32_t paletteIndex{}; paletteIndex < 4; ++paletteIndex)
+						{
+							const int distance{ CalculateColorDistance(pTexels[index], palette[paletteIndex]) };
+
+							if (distance < bestDistance)
+							{
+								bestDistance = distance;
+								bestPaletteIndex = paletteIndex;
+							}
+						}
+
+						indices |= bestPaletteIndex << (2 * index);
+					}
+				}
+
+				std::memcpy(pBlock, &color0, sizeof(color0));
+				std::memcpy(pBlock + 2, &color1, sizeof(color1));
+				std::memcpy(pBlock + 4, &indices, sizeof(indices));
+			}
+
+			void DecodeColorBlock(const uint8_t* pBlock, bool forceFourColors, uint32_t* pTexels)
+			{
+				uint16_t color0{};
+				uint16_t color1{};
+				uint32_t indices{};
+
+				std::memcpy(&color0, pBlock, sizeof(color0));
+				std::memcpy(&color1, pBlock + 2, sizeof(color1));
+				std::memcpy(&indices, pBlock + 4, sizeof(indices));
+
+				uint32_t palette[4]{};
+				CalculateColorPalette(color0, color1, forceFourColors || color0 > color1, palette);
+
+				for (int index{}; index < amountOfTexelsPerBlock; ++index)
+				{
+					pTexels[index] = palette[indices >> (2 * index) & 0b11];
+				}
+			}
+
+			void CalculateChannelPalette(uint8_t value0, uint8_t value1, uint8_t palette[8])
+			{
+				palette[0] = value0;
+				palette[1] = value1;
+
+				if (value0 > value1)
+				{
+					for (int index{ 1 }; index < 7; ++index)
+					{
+						palette[index + 1] = static_cast<uint8_t>(((7 - index) * value0 + index * value1 + 3) / 7);
+					}
+				}
+				else
+				{
+					for (int index{ 1 }; index < 5; ++index)
+					{
+						palette[index + 1] = static_cast<uint8_t>(((5 - index) * value0 + index * value1 + 2) / 5);
+					}
+
+					palette[6] = 0;
+					palette[7] = 255;
+				}
+			}
+
+			//a single channel with 2 endpoints and 3 bit indices (the BC4 block layout), always uses the eight value mode
+			void EncodeChannelBlock(const uint32_t* pTexels, int channel, uint8_t* pBlock)
+			{
+				uint8_t min{ 255 };
+				uint8_t max{};
+
+				for (int index{}; index < amountOfTexelsPerBlock; ++index)
+				{
+					min = std::min(min, GetChannel(pTexels[index], channel));
+					max = std::max(max, GetChannel(pTexels[index], channel));
+				}
+
+				uint64_t indices{};
+
+				if (min != max)
+				{
+					uint8_t palette[8]{};
+					CalculateChannelPalette(max, min, palette);
+
+					for (int index{}; index < amountOfTexelsPerBlock; ++index)
+					{
+						const int value{ GetChannel(pTexels[index], channel) };
+						uint64_t bestPaletteIndex{};
+						int bestDistance{ INT_MAX };
+
+						for (uint64_t paletteIndex{}; paletteIndex < 8; ++paletteIndex)
+						{
+							const int distance{ std::abs(value - palette[paletteIndex]) };
+
+							if (distance < bestDistance)
+							{
+								bestDistance = distance;
+								bestPaletteIndex = paletteIndex;
+							}
+						}
+
+						indices |= bestPaletteIndex << (3 * index);
+					}
+				}
+
+				pBlock[0] = max;
+				pBlock[1] = min;
+
+				//48 bits of indices, little endian
+				for (int byte{}; byte < 6; ++byte)
+				{
+					pBlock[2 + byte] = static_cast<uint8_t>(indices >> (8 * byte));
+				}
+			}
+
+			void DecodeChannelBlock(const uint8_t* pBlock, int channel, uint32_t* pTexels)
+			{
+				uint8_t palette[8]{};
+				CalculateChannelPalette(pBlock[0], pBlock[1], palette);
+
+				uint64_t indices{};
+
+				for (int byte{}; byte < 6; ++byte)
+				{
+					indices |= static_cast<uint64_t>(pBlock[2 + byte]) << (8 * byte);
+				}
+
+				const uint32_t mask{ ~(0xFFu << (8 * channel)) };
+
+				for (int index{}; index < amountOfTexelsPerBlock; ++index)
+				{
+					pTexels[index] = (pTexels[index] & mask) | static_cast<uint32_t>(palette[indices >> (3 * index) & 0b111]) << (8 * channel);
+				}
+			}
+		}
+
+		void EncodeBC1(const uint32_t* pTexels, uint8_t* pBlock)
+		{
+			EncodeColorBlock(pTexels, pBlock);
+		}
+
+		void EncodeBC3(const uint32_t* pTexels, uint8_t* pBlock)
+		{
+			EncodeChannelBlock(pTexels, 3, pBlock);
+			EncodeColorBlock(pTexels, pBlock + 8);
+		}
+
+		void EncodeBC5(const uint32_t* pTexels, uint8_t* pBlock)
+		{
+			EncodeChannelBlock(pTexels, 0, pBlock);
+			EncodeChannelBlock(pTexels, 1, pBlock + 8);
+		}
+
+		void DecodeBC1(const uint8_t* pBlock, uint32_t* pTexels)
+		{
+			DecodeColorBlock(pBlock, false, pTexels);
+		}
+
+		void DecodeBC3(const uint8_t* pBlock, uint32_t* pTexels)
+		{
+			//the color part of BC3 always has four colors
+			DecodeColorBlock(pBlock + 8, true, pTexels);
+			DecodeChannelBlock(pBlock, 3, pTexels);
+		}
+
+		void DecodeBC5(const uint8_t* pBlock, uint32_t* pTexels)
+		{
+			std::fill(pTexels, pTexels + amountOfTexelsPerBlock, 0xFF000000);
+
+			DecodeChannelBlock(pBlock, 0, pTexels);
+			DecodeChannelBlock(pBlock + 8, 1, pTexels);
+		}
+	}
+}
\ No newline at end of file
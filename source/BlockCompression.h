@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+namespace dae
+{
+	//CPU encoders and decoders for the D3D block compression formats
+	//a block holds 4x4 texels in rows, texels are R8G8B8A8 with red in the lowest byte
+	namespace BlockCompression
+	{
+		constexpr int blockSize{ 4 };
+		constexpr int amountOfTexelsPerBlock{ blockSize * blockSize };
+
+		//BC1: RGB with 2 endpoints and 2 bit indices, 8 bytes per block
+		constexpr int bc1BytesPerBlock{ 8 };
+		//BC3: BC1 color + separately interpolated alpha, 16 bytes per block
+		constexpr int bc3BytesPerBlock{ 16 };
+		//BC5: two separately interpolated channels (red and green), 16 bytes per block
+		constexpr int bc5BytesPerBlock{ 16 };
+
+		void EncodeBC1(const uint32_t* pTexels, uint8_t* pBlock);
+		void EncodeBC3(const uint32_t* pTexels, uint8_t* pBlock);
+		void EncodeBC5(const uint32_t* pTexels, uint8_t* pBlock);
+
+		void DecodeBC1(const uint8_t* pBlock, uint32_t* pTexels);
+		void DecodeBC3(const uint8_t* pBlock, uint32_t* pTexels);
+		//blue is 0 and alpha 1, like the D3D sampler returns it
+		void DecodeBC5(const uint8_t* pBlock, uint32_t* pTexels);
+	}
+}
\ No newline at end of file
@@ -21,7 +21,7 @@ namespace dae
 
 		static ColorRGBA Lerp(const ColorRGBA& c1, const ColorRGBA& c2, float factor)
 		{
-			return { Lerpf(c1.r, c2.r, factor), Lerpf(c1.g, c2.g, factor), Lerpf(c1.b, c2.b, factor), Lerpf(c1.a, c2.b, factor) };
+			return { Lerpf(c1.r, c2.r, factor), Lerpf(c1.g, c2.g, factor), Lerpf(c1.b, c2.b, factor), Lerpf(c1.a, c2.a, factor) };
 		}
 
 #pragma region ColorRGBA (Member) Operators
@@ -12,10 +12,10 @@ Effect::Effect(ID3D11Device* pDevice, const std::wstring& filePath)
 		std::wcout << L"Technique not valid\n";
 	}
 
-	m_pWorldViewProjMatrixVariable = m_pEffect->GetVariableByName("gWorldViewProj")->AsMatrix();
-	if (!m_pWorldViewProjMatrixVariable->IsValid())
+	m_pViewProjMatrixVariable = m_pEffect->GetVariableByName("gViewProj")->AsMatrix();
+	if (!m_pViewProjMatrixVariable->IsValid())
 	{
-		std::wcout << L"m_pMatWorldViewProjVariable not valid!\n";
+		std::wcout << L"m_pViewProjMatrixVariable not valid!\n";
 	}
 
 	m_pDiffuseMapVariable = m_pEffect->GetVariableByName("gDiffuseMap")->AsShaderResource();
@@ -40,10 +40,10 @@ Effect::~Effect()
 		m_pEffect->Release();
 }
 
-void Effect::SetWorldViewProjMatrix(const dae::Matrix& worldViewProjMatrix)
+void Effect::SetViewProjMatrix(const dae::Matrix& viewProjMatrix)
 {
-	if (m_pWorldViewProjMatrixVariable)
-		m_pWorldViewProjMatrixVariable->SetMatrix(reinterpret_cast<const float*>(&worldViewProjMatrix));
+	if (m_pViewProjMatrixVariable)
+		m_pViewProjMatrixVariable->SetMatrix(reinterpret_cast<const float*>(&viewProjMatrix));
 }
 
 void Effect::SetDiffuseMap(dae::Texture* pDiffuseTexture)
@@ -52,6 +52,20 @@ void Effect::SetDiffuseMap(dae::Texture* pDiffuseTexture)
 		m_pDiffuseMapVariable->SetResource(pDiffuseTexture->GetSRV());
 }
 
+void Effect::SetInstanceElements(D3D11_INPUT_ELEMENT_DESC* pInstanceElements)
+{
+	for (uint32_t row{}; row < amountOfInstanceElements; ++row)
+	{
+		pInstanceElements[row].SemanticName = "WORLD";
+		pInstanceElements[row].SemanticIndex = row;
+		pInstanceElements[row].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		pInstanceElements[row].InputSlot = 1;
+		pInstanceElements[row].AlignedByteOffset = row * sizeof(float) * 4;
+		pInstanceElements[row].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+		pInstanceElements[row].InstanceDataStepRate = 1;
+	}
+}
+
 ID3DX11Effect* Effect::LoadEffect(ID3D11Device* pDevice, const std::wstring& filePath)
 {
 	ID3D10Blob* pErrorBlob{};
@@ -21,7 +21,7 @@ public:
 	ID3DX11Effect* GetEffect() const { return m_pEffect; }
 	ID3DX11EffectTechnique* GetTechnique() const { return m_pTechnique; }
 	ID3D11InputLayout* GetInputLayout() const { return m_pInputLayout; }
-	void SetWorldViewProjMatrix(const dae::Matrix& worldViewProjMatrix);
+	void SetViewProjMatrix(const dae::Matrix& viewProjMatrix);
 	void SetDiffuseMap(dae::Texture* pDiffuseTexture);
 
 protected:
@@ -29,8 +29,12 @@ protected:
 	ID3DX11EffectTechnique* m_pTechnique;
 	ID3D11InputLayout* m_pInputLayout;
 	
-	ID3DX11EffectMatrixVariable* m_pWorldViewProjMatrixVariable;
+	ID3DX11EffectMatrixVariable* m_pViewProjMatrixVariable;
 	ID3DX11EffectShaderResourceVariable* m_pDiffuseMapVariable;
+
+	//the world matrix of every instance comes from the second vertex buffer (Mesh::SetInstanceBuffer), a row per element
+	static constexpr uint32_t amountOfInstanceElements{ 4 };
+	static void SetInstanceElements(D3D11_INPUT_ELEMENT_DESC* pInstanceElements);
 	
 private:
 	static ID3DX11Effect* LoadEffect(ID3D11Device* pDevice, const std::wstring& filePath);
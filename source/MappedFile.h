@@ -0,0 +1,32 @@
+#pragma once
+#include "pch.h"
+#include <string>
+
+namespace dae
+{
+	//read-only view of a whole file, the OS pages it in on access and can share the pages between processes
+	class MappedFile final
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile(MappedFile&& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+		MappedFile& operator=(MappedFile&& other) = delete;
+
+		//returns false when the file doesn't exist, is empty or can't be mapped
+		bool Open(const std::string& path);
+		void Close();
+
+		const uint8_t* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		HANDLE m_File{ INVALID_HANDLE_VALUE };
+		HANDLE m_Mapping{ nullptr };
+		const uint8_t* m_pData{ nullptr };
+		size_t m_Size{};
+	};
+}
\ No newline at end of file
@@ -5,29 +5,418 @@
 #include "OpaqueEffect.h"
 #include "PartialCoverageEffect.h"
 #include "Camera.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "VertexCompression.h"
 #include <cassert>
+#include <filesystem>
+
+//SSE2 is always available on x64, other targets use the scalar fallback
+#if defined(_M_X64) || defined(__SSE2__)
+#define MESH_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace dae
 {
-	Mesh::Mesh(ID3D11Device* pDevice, const std::string& modelFilePath, float windowWidth, float windowHeight)
+	namespace
+	{
+		//parsed meshes are cached on disk, the hash of a file name covers the obj file and the version
+		//bump the version when the layout of the data or the parser changes
+		constexpr uint32_t meshCacheMagic{ 0x4853454D }; //"MESH"
+		constexpr uint32_t meshCacheVersion{ 6 };
+		constexpr size_t meshCacheAlignment{ 16 };
+
+		struct MeshCacheHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vertexSize; //tells the vertex formats apart
+			uint32_t amountOfVertices;
+			uint32_t amountOfIndices;
+			uint32_t amountOfMeshlets;
+			uint32_t amountOfLevelsOfDetail;
+			uint32_t padding;
+			//from the start of the file, aligned to meshCacheAlignment
+			uint64_t vertexOffset;
+			uint64_t indexOffset;
+			uint64_t meshletOffset;
+			uint64_t levelOfDetailOffset;
+			Vector3 boundsMin;
+			Vector3 boundsMax;
+			float boundingRadius;
+		};
+
+		size_t AlignMeshCacheOffset(size_t offset)
+		{
+			return (offset + meshCacheAlignment - 1) / meshCacheAlignment * meshCacheAlignment;
+		}
+
+		//planes of the clip space volume in the space the matrix transforms from, their normals point inwards
+		//with row vectors a plane is a sum of columns of the matrix, w is the distance
+		void ExtractFrustumPlanes(const Matrix& matrix, Vector4 (&planes)[6])
+		{
+			for (int column{}; column < 3; ++column)
+			{
+				for (int row{}; row < 4; ++row)
+				{
+					const float w{ matrix[row][3] };
+					const float value{ matrix[row][column] };
+
+					if (column < 2)
+					{
+						planes[column * 2][row] = w + value;
+						planes[column * 2 + 1][row] = w - value;
+					}
+					else
+					{
+						//depth goes from 0 to w
+						planes[4][row] = value;
+						planes[5][row] = w - value;
+					}
+				}
+			}
+
+			for (Vector4& plane : planes)
+			{
+				plane = plane * (1.f / plane.GetXYZ().Magnitude());
+			}
+		}
+
+		//rotation and translation only: the axes have length 1, are perpendicular and not mirrored
+		bool IsRigidTransform(const Matrix& matrix)
+		{
+			constexpr float tolerance{ 1e-3f };
+
+			const Vector3 axisX{ matrix[0].GetXYZ() };
+			const Vector3 axisY{ matrix[1].GetXYZ() };
+			const Vector3 axisZ{ matrix[2].GetXYZ() };
+
+			return std::abs(axisX.SqrMagnitude() - 1.f) < tolerance && std::abs(axisY.SqrMagnitude() - 1.f) < tolerance && std::abs(axisZ.SqrMagnitude() - 1.f) < tolerance
+				&& std::abs(Vector3::Dot(axisX, axisY)) < tolerance && std::abs(Vector3::Dot(axisY, axisZ)) < tolerance && std::abs(Vector3::Dot(axisZ, axisX)) < tolerance
+				&& Vector3::Dot(Vector3::Cross(axisX, axisY), axisZ) > 0.f;
+		}
+
+#ifdef MESH_USE_SSE2
+		//one register per component of four vectors, so four vertices are transformed with the instructions of one
+		struct Vector3x4
+		{
+			__m128 x;
+			__m128 y;
+			__m128 z;
+		};
+
+		struct Vector4x4
+		{
+			__m128 x;
+			__m128 y;
+			__m128 z;
+			__m128 w;
+		};
+
+		Vector3x4 LoadVector3x4(const Vector3& v0, const Vector3& v1, const Vector3& v2, const Vector3& v3)
+		{
+			return { _mm_setr_ps(v0.x, v1.x, v2.x, v3.x), _mm_setr_ps(v0.y, v1.y, v2.y, v3.y), _mm_setr_ps(v0.z, v1.z, v2.z, v3.z) };
+		}
+
+		void StoreVector3x4(const Vector3x4& vectors, Vector3 (&result)[4])
+		{
+			alignas(16) float x[4];
+			alignas(16) float y[4];
+			alignas(16) float z[4];
+			_mm_store_ps(x, vectors.x);
+			_mm_store_ps(y, vectors.y);
+			_mm_store_ps(z, vectors.z);
+
+			for (size_t lane{}; lane < 4; ++lane)
+			{
+				result[lane] = { x[lane], y[lane], z[lane] };
+			}
+		}
+
+		void StoreVector4x4(const Vector4x4& vectors, Vector4 (&result)[4])
+		{
+			alignas(16) float x[4];
+			alignas(16) float y[4];
+			alignas(16) float z[4];
+			alignas(16) float w[4];
+			_mm_store_ps(x, vectors.x);
+			_mm_store_ps(y, vectors.y);
+			_mm_store_ps(z, vectors.z);
+			_mm_store_ps(w, vectors.w);
+
+			for (size_t lane{}; lane < 4; ++lane)
+			{
+				result[lane] = { x[lane], y[lane], z[lane], w[lane] };
+			}
+		}
+
+		//every element of a matrix in all four lanes, made once for all the vertices of an instance
+		struct Matrix4x4
+		{
+			__m128 elements[4][4];
+		};
+
+		Matrix4x4 BroadcastMatrix(const Matrix& matrix)
+		{
+			Matrix4x4 result{};
+
+			for (int row{}; row < 4; ++row)
+			{
+				const Vector4 rowElements{ matrix[row] };
+				result.elements[row][0] = _mm_set1_ps(rowElements.x);
+				result.elements[row][1] = _mm_set1_ps(rowElements.y);
+				result.elements[row][2] = _mm_set1_ps(rowElements.z);
+				result.elements[row][3] = _mm_set1_ps(rowElements.w);
+			}
+
+			return result;
+		}
+
+		//the products are added in the order of Matrix::TransformVector, so the results match the scalar path
+		__m128 TransformComponent(const Matrix4x4& matrix, const Vector3x4& v, int column)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(matrix.elements[0][column], v.x), _mm_mul_ps(matrix.elements[1][column], v.y)), _mm_mul_ps(matrix.elements[2][column], v.z));
+		}
+
+		Vector3x4 TransformVector3x4(const Matrix4x4& matrix, const Vector3x4& v)
+		{
+			return { TransformComponent(matrix, v, 0), TransformComponent(matrix, v, 1), TransformComponent(matrix, v, 2) };
+		}
+
+		Vector3x4 TransformPoint3x4(const Matrix4x4& matrix, const Vector3x4& p)
+		{
+			return
+			{
+				_mm_add_ps(TransformComponent(matrix, p, 0), matrix.elements[3][0]),
+				_mm_add_ps(TransformComponent(matrix, p, 1), matrix.elements[3][1]),
+				_mm_add_ps(TransformComponent(matrix, p, 2), matrix.elements[3][2])
+			};
+		}
+
+		Vector4x4 TransformPoint4x4(const Matrix4x4& matrix, const Vector3x4& p)
+		{
+			const Vector3x4 xyz{ TransformPoint3x4(matrix, p) };
+			return { xyz.x, xyz.y, xyz.z, _mm_add_ps(TransformComponent(matrix, p, 3), matrix.elements[3][3]) };
+		}
+
+		Vector3x4 CrossVector3x4(const Vector3x4& v1, const Vector3x4& v2)
+		{
+			return
+			{
+				_mm_sub_ps(_mm_mul_ps(v1.y, v2.z), _mm_mul_ps(v1.z, v2.y)),
+				_mm_sub_ps(_mm_mul_ps(v1.z, v2.x), _mm_mul_ps(v1.x, v2.z)),
+				_mm_sub_ps(_mm_mul_ps(v1.x, v2.y), _mm_mul_ps(v1.y, v2.x))
+			};
+		}
+
+		Vector3x4 MultiplyVector3x4(const Vector3x4& v, __m128 scale)
+		{
+			return { _mm_mul_ps(v.x, scale), _mm_mul_ps(v.y, scale), _mm_mul_ps(v.z, scale) };
+		}
+
+		Vector3x4 SubtractVector3x4(const Vector3x4& v1, const Vector3x4& v2)
+		{
+			return { _mm_sub_ps(v1.x, v2.x), _mm_sub_ps(v1.y, v2.y), _mm_sub_ps(v1.z, v2.z) };
+		}
+#endif
+	}
+
+	Mesh::Mesh(ID3D11Device* pDevice, const std::string& modelFilePath, float windowWidth, float windowHeight, VertexFormat vertexFormat, bool keepTriangleOrder)
+		: m_RotationAngle{}
+		, m_RotationSpeed{ 0.785398163f } //45 degrees per second
+		, m_WindowWidth{ windowWidth }
+		, m_WindowHeight{ windowHeight }
+		, m_VertexFormat{ vertexFormat }
+	{
+		const std::string cachePath{ GetCachePath(modelFilePath, vertexFormat, keepTriangleOrder) };
+
+		if (cachePath.empty() || !LoadFromCache(cachePath))
+		{
+			Utils::ParseOBJ(modelFilePath, m_VertexStorage, m_IndexStorage);
+			BuildModel(modelFilePath, keepTriangleOrder);
+
+			if (!cachePath.empty() && !m_Indices.empty())
+				SaveToCache(cachePath);
+		}
+
+		CreateResources(pDevice);
+	}
+
+	Mesh::Mesh(ID3D11Device* pDevice, const std::string& modelName, std::vector<Vertex_In>&& vertices, std::vector<uint32_t>&& indices, const std::string& cachePath, float windowWidth, float windowHeight, VertexFormat vertexFormat, bool keepTriangleOrder)
 		: m_RotationAngle{}
 		, m_RotationSpeed{ 0.785398163f } //45 degrees per second
 		, m_WindowWidth{ windowWidth }
 		, m_WindowHeight{ windowHeight }
+		, m_VertexFormat{ vertexFormat }
+	{
+		if (cachePath.empty() || !LoadFromCache(cachePath))
+		{
+			m_VertexStorage = std::move(vertices);
+			m_IndexStorage = std::move(indices);
+			BuildModel(modelName, keepTriangleOrder);
+
+			if (!cachePath.empty() && !m_Indices.empty())
+				SaveToCache(cachePath);
+		}
+
+		CreateResources(pDevice);
+	}
+
+	Mesh::~Mesh()
+	{
+		if (m_pVertexBuffer)
+		{
+			m_pVertexBuffer->Release();
+		}
+
+		if (m_pIndexBuffer)
+		{
+			m_pIndexBuffer->Release();
+		}
+
+		if (m_pInstanceBuffer)
+		{
+			m_pInstanceBuffer->Release();
+		}
+
+		delete m_pCacheFile;
+	}
+
+	std::string Mesh::GetCachePath(const std::string& modelFilePath, VertexFormat vertexFormat, bool keepTriangleOrder)
+	{
+		MappedFile modelFile{};
+
+		if (!modelFile.Open(modelFilePath))
+			return {};
+
+		uint64_t hash{ Utils::HashBytes(modelFile.GetData(), modelFile.GetSize()) };
+		hash = Utils::HashBytes(&meshCacheVersion, sizeof(meshCacheVersion), hash);
+		hash = Utils::HashBytes(&keepTriangleOrder, sizeof(keepTriangleOrder), hash);
+		hash = Utils::HashBytes(&vertexFormat, sizeof(vertexFormat), hash);
+
+		return Utils::GetCachePath(hash, ".mesh");
+	}
+
+	std::string Mesh::GetPartListPath(const std::string& modelFilePath, VertexFormat vertexFormat, bool keepTriangleOrder, uint32_t maxVerticesPerPart)
+	{
+		MappedFile modelFile{};
+
+		if (!modelFile.Open(modelFilePath))
+			return {};
+
+		uint64_t hash{ Utils::HashBytes(modelFile.GetData(), modelFile.GetSize()) };
+		hash = Utils::HashBytes(&meshCacheVersion, sizeof(meshCacheVersion), hash);
+		hash = Utils::HashBytes(&keepTriangleOrder, sizeof(keepTriangleOrder), hash);
+		hash = Utils::HashBytes(&vertexFormat, sizeof(vertexFormat), hash);
+		hash = Utils::HashBytes(&maxVerticesPerPart, sizeof(maxVerticesPerPart), hash);
+
+		return Utils::GetCachePath(hash, ".parts");
+	}
+
+	std::string Mesh::GetPartCachePath(const std::string& partListPath, uint32_t part)
 	{
-		Utils::ParseOBJ(modelFilePath, m_Vertices, m_Indices);
+		return std::filesystem::path{ partListPath }.replace_extension().string() + '_' + std::to_string(part) + ".mesh";
+	}
+
+	void Mesh::BuildModel(const std::string& modelName, bool keepTriangleOrder)
+	{
+		Vector3 boundsMax{};
+
+		if (!m_VertexStorage.empty())
+		{
+			m_BoundsMin = m_VertexStorage.front().position;
+			boundsMax = m_VertexStorage.front().position;
+		}
+
+		for (const Vertex_In& vertex : m_VertexStorage)
+		{
+			m_BoundsMin = Vector3::Min(m_BoundsMin, vertex.position);
+			boundsMax = Vector3::Max(boundsMax, vertex.position);
+			m_BoundingRadius = std::max(m_BoundingRadius, vertex.position.Magnitude());
+		}
+
+		m_BoundsExtent = boundsMax - m_BoundsMin;
+
+		//the meshlet bounds have to hold the positions that are rendered, so those are quantized first
+		if (m_VertexFormat == VertexFormat::compact)
+		{
+			for (Vertex_In& vertex : m_VertexStorage)
+			{
+				vertex = VertexCompression::DecompressVertex(VertexCompression::CompressVertex(vertex, m_BoundsMin, m_BoundsExtent), m_BoundsMin, m_BoundsExtent);
+			}
+		}
+
+		//only done when the model is parsed, the cache file stores the optimized order
+		const float missRatioBefore{ MeshOptimizer::CalculateACMR(m_IndexStorage, m_VertexStorage.size()) };
+
+		BuildLevelsOfDetail(keepTriangleOrder);
+
+		const std::vector<uint32_t> fullDetailIndices{ m_IndexStorage.begin(), m_IndexStorage.begin() + m_LevelOfDetailStorage.front().amountOfIndices };
+		const float missRatioAfter{ MeshOptimizer::CalculateACMR(fullDetailIndices, m_VertexStorage.size()) };
+		MeshOptimizer::OptimizeVertexFetch(m_VertexStorage, m_IndexStorage);
+
+		std::cout << modelName << " vertex cache miss ratio: " << missRatioBefore << " -> " << missRatioAfter << ", " << m_MeshletStorage.size() << " meshlets, triangles per level of detail:";
+
+		for (const LevelOfDetail& levelOfDetail : m_LevelOfDetailStorage)
+		{
+			std::cout << ' ' << levelOfDetail.amountOfIndices / 3;
+		}
+
+		std::cout << '\n';
+
+		m_Indices = m_IndexStorage;
+		m_Meshlets = m_MeshletStorage;
+		m_LevelsOfDetail = m_LevelOfDetailStorage;
+
+		if (m_VertexFormat == VertexFormat::compact)
+		{
+			m_CompactVertexStorage.reserve(m_VertexStorage.size());
+
+			for (const Vertex_In& vertex : m_VertexStorage)
+			{
+				m_CompactVertexStorage.emplace_back(VertexCompression::CompressVertex(vertex, m_BoundsMin, m_BoundsExtent));
+			}
+
+			//the full vertices are not needed anymore, keeping them would undo the memory that is saved
+			m_VertexStorage = {};
+			m_CompactVertices = m_CompactVertexStorage;
+		}
+		else
+		{
+			m_Vertices = m_VertexStorage;
+		}
+	}
+
+	void Mesh::CreateResources(ID3D11Device* pDevice)
+	{
+		m_AmountOfTilesX = (static_cast<int>(m_WindowWidth) + m_TileSize - 1) / m_TileSize;
+		m_AmountOfTilesY = (static_cast<int>(m_WindowHeight) + m_TileSize - 1) / m_TileSize;
+		m_TileCosts.resize(static_cast<size_t>(m_AmountOfTilesX) * m_AmountOfTilesY);
+
+		for (SoftwareFrame& frame : m_SoftwareFrames)
+		{
+			frame.tileBins.resize(m_TileCosts.size());
+		}
+
+		SetInstanceTransforms(pDevice, { Matrix{ {1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1} } });
+
+		//without a device only the model data is loaded, or parsed and cached when that wasn't done yet
+		if (!pDevice)
+			return;
 
 		HRESULT result{};
 		//Create vertex buffer
 		D3D11_BUFFER_DESC bd{};
 		bd.Usage = D3D11_USAGE_IMMUTABLE;
-		bd.ByteWidth = sizeof(Vertex_In) * static_cast<uint32_t>(m_Vertices.size());
+		bd.ByteWidth = static_cast<uint32_t>(m_VertexFormat == VertexFormat::compact ? m_CompactVertices.size_bytes() : m_Vertices.size_bytes());
 		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 		bd.CPUAccessFlags = 0;
 		bd.MiscFlags = 0;
 	
 		D3D11_SUBRESOURCE_DATA initData{};
-		initData.pSysMem = m_Vertices.data();
+		initData.pSysMem = m_VertexFormat == VertexFormat::compact ? static_cast<const void*>(m_CompactVertices.data()) : m_Vertices.data();
 	
 		result = pDevice->CreateBuffer(&bd, &initData, &m_pVertexBuffer);
 	
@@ -50,19 +439,250 @@ namespace dae
 			assert("Failed to create index buffer");
 	}
 
-	Mesh::~Mesh()
+	void Mesh::SetInstanceTransforms(ID3D11Device* pDevice, const std::vector<Matrix>& instanceTransforms)
 	{
-		if (m_pVertexBuffer)
+		assert(std::all_of(instanceTransforms.begin(), instanceTransforms.end(), IsRigidTransform) && "instance transforms may only rotate and translate");
+
+		m_InstanceTransforms = instanceTransforms;
+		UpdateInstanceWorldMatrices();
+
+		const size_t amountOfInstances{ m_InstanceTransforms.size() };
+
+		for (SoftwareFrame& frame : m_SoftwareFrames)
 		{
-			m_pVertexBuffer->Release();
+			frame.verticesOut.resize(GetAmountOfVertices() * amountOfInstances);
+			frame.isVertexTransformed.resize(GetAmountOfVertices() * amountOfInstances);
+			frame.visibleMeshlets.reserve(m_Meshlets.size() * amountOfInstances);
+			frame.triangleAreas.resize(GetAmountOfTriangles() * amountOfInstances);
 		}
 
-		if (m_pIndexBuffer)
+		if (pDevice)
+			CreateInstanceBuffer(pDevice);
+	}
+
+	void Mesh::UpdateInstanceWorldMatrices()
+	{
+		m_InstanceWorldMatrices.resize(m_InstanceTransforms.size());
+
+		for (size_t instance{}; instance < m_InstanceTransforms.size(); ++instance)
 		{
-			m_pIndexBuffer->Release();
+			m_InstanceWorldMatrices[instance] = m_WorldMatrix * m_InstanceTransforms[instance];
 		}
 	}
 
+	void Mesh::CreateInstanceBuffer(ID3D11Device* pDevice)
+	{
+		if (m_pInstanceBuffer)
+		{
+			m_pInstanceBuffer->Release();
+			m_pInstanceBuffer = nullptr;
+		}
+
+		D3D11_BUFFER_DESC bd{};
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.ByteWidth = static_cast<uint32_t>(sizeof(Matrix) * m_InstanceWorldMatrices.size());
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		bd.MiscFlags = 0;
+
+		const HRESULT result{ pDevice->CreateBuffer(&bd, nullptr, &m_pInstanceBuffer) };
+
+		if (FAILED(result))
+			assert("Failed to create instance buffer");
+	}
+
+	void Mesh::SetInstanceBuffer(ID3D11DeviceContext* pDeviceContext) const
+	{
+		D3D11_MAPPED_SUBRESOURCE mappedInstances{};
+		const HRESULT result{ pDeviceContext->Map(m_pInstanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedInstances) };
+
+		if (FAILED(result))
+			assert("Failed to map instance buffer");
+
+		std::memcpy(mappedInstances.pData, m_InstanceWorldMatrices.data(), sizeof(Matrix) * m_InstanceWorldMatrices.size());
+		pDeviceContext->Unmap(m_pInstanceBuffer, 0);
+
+		constexpr UINT stride{ sizeof(Matrix) };
+		constexpr UINT offset{ 0 };
+		pDeviceContext->IASetVertexBuffers(1, 1, &m_pInstanceBuffer, &stride, &offset);
+	}
+
+	float Mesh::CalculateNearestInstanceDistance(const Vector3& position) const
+	{
+		float nearestDistance{ INFINITY };
+
+		for (const Matrix& instanceWorldMatrix : m_InstanceWorldMatrices)
+		{
+			nearestDistance = std::min(nearestDistance, (instanceWorldMatrix.GetTranslation() - position).Magnitude());
+		}
+
+		return nearestDistance;
+	}
+
+	uint32_t Mesh::GetVertexSize() const
+	{
+		return m_VertexFormat == VertexFormat::compact ? sizeof(CompactVertex_In) : sizeof(Vertex_In);
+	}
+
+	bool Mesh::LoadFromCache(const std::string& cachePath)
+	{
+		MappedFile* pCacheFile{ new MappedFile() };
+
+		if (!pCacheFile->Open(cachePath) || pCacheFile->GetSize() < sizeof(MeshCacheHeader))
+		{
+			delete pCacheFile;
+			return false;
+		}
+
+		MeshCacheHeader header{};
+		std::memcpy(&header, pCacheFile->GetData(), sizeof(header));
+
+		//a cache file that is cut off or was written by another version is made again
+		const bool isValid
+		{
+			header.magic == meshCacheMagic
+			&& header.version == meshCacheVersion
+			&& header.vertexSize == GetVertexSize()
+			&& header.vertexOffset % meshCacheAlignment == 0 && header.indexOffset % meshCacheAlignment == 0
+			&& header.vertexOffset + static_cast<uint64_t>(header.amountOfVertices) * header.vertexSize <= pCacheFile->GetSize()
+			&& header.indexOffset + static_cast<uint64_t>(header.amountOfIndices) * sizeof(uint32_t) <= pCacheFile->GetSize()
+			&& header.meshletOffset % meshCacheAlignment == 0
+			&& header.meshletOffset + static_cast<uint64_t>(header.amountOfMeshlets) * sizeof(Meshlet) <= pCacheFile->GetSize()
+			&& header.amountOfLevelsOfDetail > 0 && header.levelOfDetailOffset % meshCacheAlignment == 0
+			&& header.levelOfDetailOffset + static_cast<uint64_t>(header.amountOfLevelsOfDetail) * sizeof(LevelOfDetail) <= pCacheFile->GetSize()
+		};
+
+		if (!isValid)
+		{
+			delete pCacheFile;
+			return false;
+		}
+
+		//the views point straight into the mapped file, nothing is copied
+		if (m_VertexFormat == VertexFormat::compact)
+			m_CompactVertices = { reinterpret_cast<const CompactVertex_In*>(pCacheFile->GetData() + header.vertexOffset), header.amountOfVertices };
+		else
+			m_Vertices = { reinterpret_cast<const Vertex_In*>(pCacheFile->GetData() + header.vertexOffset), header.amountOfVertices };
+
+		m_Indices = { reinterpret_cast<const uint32_t*>(pCacheFile->GetData() + header.indexOffset), header.amountOfIndices };
+		m_Meshlets = { reinterpret_cast<const Meshlet*>(pCacheFile->GetData() + header.meshletOffset), header.amountOfMeshlets };
+		m_LevelsOfDetail = { reinterpret_cast<const LevelOfDetail*>(pCacheFile->GetData() + header.levelOfDetailOffset), header.amountOfLevelsOfDetail };
+		m_BoundsMin = header.boundsMin;
+		m_BoundsExtent = header.boundsMax - header.boundsMin;
+		m_BoundingRadius = header.boundingRadius;
+		m_pCacheFile = pCacheFile;
+
+		return true;
+	}
+
+	void Mesh::SaveToCache(const std::string& cachePath) const
+	{
+		const bool isCompact{ m_VertexFormat == VertexFormat::compact };
+		const char* pVertexData{ isCompact ? reinterpret_cast<const char*>(m_CompactVertices.data()) : reinterpret_cast<const char*>(m_Vertices.data()) };
+		const size_t amountOfVertices{ isCompact ? m_CompactVertices.size() : m_Vertices.size() };
+		const size_t vertexDataSize{ amountOfVertices * GetVertexSize() };
+
+		MeshCacheHeader header{ meshCacheMagic, meshCacheVersion, GetVertexSize(), static_cast<uint32_t>(amountOfVertices), static_cast<uint32_t>(m_Indices.size()), static_cast<uint32_t>(m_Meshlets.size()), static_cast<uint32_t>(m_LevelsOfDetail.size()) };
+
+		header.vertexOffset = AlignMeshCacheOffset(sizeof(MeshCacheHeader));
+		header.indexOffset = AlignMeshCacheOffset(header.vertexOffset + vertexDataSize);
+		header.meshletOffset = AlignMeshCacheOffset(header.indexOffset + m_Indices.size_bytes());
+		header.levelOfDetailOffset = AlignMeshCacheOffset(header.meshletOffset + m_Meshlets.size_bytes());
+		header.boundsMin = m_BoundsMin;
+		header.boundsMax = m_BoundsMin + m_BoundsExtent;
+		header.boundingRadius = m_BoundingRadius;
+
+		Utils::WriteCacheFile(cachePath, [&](std::ofstream& file)
+		{
+			const std::vector<char> padding(meshCacheAlignment);
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(padding.data(), header.vertexOffset - sizeof(header));
+			file.write(pVertexData, vertexDataSize);
+			file.write(padding.data(), header.indexOffset - header.vertexOffset - vertexDataSize);
+			file.write(reinterpret_cast<const char*>(m_Indices.data()), m_Indices.size_bytes());
+			file.write(padding.data(), header.meshletOffset - header.indexOffset - m_Indices.size_bytes());
+			file.write(reinterpret_cast<const char*>(m_Meshlets.data()), m_Meshlets.size_bytes());
+			file.write(padding.data(), header.levelOfDetailOffset - header.meshletOffset - m_Meshlets.size_bytes());
+			file.write(reinterpret_cast<const char*>(m_LevelsOfDetail.data()), m_LevelsOfDetail.size_bytes());
+		});
+	}
+
+	void Mesh::BuildLevelsOfDetail(bool keepTriangleOrder)
+	{
+		//every level is simplified from the previous one to half its triangles, the errors add up
+		std::vector<uint32_t> levelIndices{ std::move(m_IndexStorage) };
+		float levelError{};
+
+		m_IndexStorage.clear();
+		m_MeshletStorage.clear();
+		m_LevelOfDetailStorage.clear();
+
+		for (uint32_t level{}; level < m_MaxLevelsOfDetail; ++level)
+		{
+			if (level > 0)
+			{
+				//blending without sorting depends on the triangle order, which simplifying would change
+				if (keepTriangleOrder || levelIndices.empty())
+					break;
+
+				float collapseError{};
+				std::vector<uint32_t> simplifiedIndices{ MeshOptimizer::Simplify(m_VertexStorage, levelIndices, levelIndices.size() / 6 * 3, collapseError) };
+
+				//seams, borders and locked positions stop the simplification, a level that is barely smaller isn't worth its memory
+				if (simplifiedIndices.size() > levelIndices.size() / 4 * 3)
+					break;
+
+				levelIndices = std::move(simplifiedIndices);
+				levelError += collapseError;
+			}
+
+			std::vector<uint32_t> indices{ levelIndices };
+
+			if (!keepTriangleOrder)
+				MeshOptimizer::OptimizeVertexCache(indices, m_VertexStorage.size());
+
+			std::vector<Meshlet> meshlets{ MeshOptimizer::BuildMeshlets(m_VertexStorage, indices, keepTriangleOrder) };
+
+			//the levels are runs of the index buffer and of the meshlets after each other
+			const LevelOfDetail levelOfDetail{ static_cast<uint32_t>(m_IndexStorage.size()), static_cast<uint32_t>(indices.size()),
+				static_cast<uint32_t>(m_MeshletStorage.size()), static_cast<uint32_t>(meshlets.size()), levelError };
+
+			for (Meshlet& meshlet : meshlets)
+			{
+				meshlet.firstTriangle += levelOfDetail.firstIndex / 3;
+			}
+
+			m_IndexStorage.insert(m_IndexStorage.end(), indices.begin(), indices.end());
+			m_MeshletStorage.insert(m_MeshletStorage.end(), meshlets.begin(), meshlets.end());
+			m_LevelOfDetailStorage.push_back(levelOfDetail);
+		}
+	}
+
+	uint32_t Mesh::SelectLevelOfDetail(const Camera& camera, float distance) const
+	{
+		//distance to the nearest point of the bounding sphere, so no part of the mesh is closer than what the error is projected at
+		const float pixelsPerUnit{ camera.projectionMatrix[1][1] * m_WindowHeight / 2.f / std::max(distance - m_BoundingRadius, camera.nearPlane) };
+
+		//the coarsest level whose error stays below a pixel on screen
+		uint32_t selectedLevel{};
+
+		for (uint32_t level{ 1 }; level < m_LevelsOfDetail.size(); ++level)
+		{
+			if (m_LevelsOfDetail[level].error * pixelsPerUnit > m_MaxScreenSpaceError)
+				break;
+
+			selectedLevel = level;
+		}
+
+		return selectedLevel;
+	}
+
+	void Mesh::UpdateLevelOfDetail(const Camera& camera)
+	{
+		m_LevelOfDetail = SelectLevelOfDetail(camera, CalculateNearestInstanceDistance(camera.origin));
+	}
+
 	void Mesh::ToggleBoundingBoxVisualization()
 	{
 		m_VisualzeBoundingBox = !m_VisualzeBoundingBox;
@@ -81,52 +701,259 @@ namespace dae
 	{
 		m_RotationAngle = angle;
 		m_WorldMatrix = Matrix::CreateRotationY(m_RotationAngle) * Matrix::CreateTranslation(m_WorldMatrix.GetTranslation());
+		UpdateInstanceWorldMatrices();
 	}
 
-	void Mesh::VertexTransformationFunction(const Camera& camera)
+	void Mesh::PrepareSoftwareFrame(const Camera& camera, uint32_t frameIndex)
 	{
-		m_VerticesOut.clear();
-		Matrix worldViewProjectionMatrix{ m_WorldMatrix * camera.viewMatrix * camera.projectionMatrix };
+		SoftwareFrame& frame{ m_SoftwareFrames[frameIndex] };
+
+		CullMeshlets(camera, frame);
+		VertexTransformationFunction(camera, frame);
 
-		for (const Vertex_In& vertex : m_Vertices)
+		//clear keeps the capacity, so after the first frames binning doesn't allocate anymore
+		for (std::vector<uint32_t>& tileBin : frame.tileBins)
 		{
-			Vertex_Out vertexOut{};
+			tileBin.clear();
+		}
 
-			vertexOut.position = worldViewProjectionMatrix.TransformPoint({ vertex.position.x, vertex.position.y, vertex.position.z, 0 });
+		BinTriangles(frame);
+	}
 
-			//perspective divide
-			const float wInversed{ 1.f / vertexOut.position.w };
-			vertexOut.position.x *= wInversed;
-			vertexOut.position.y *= wInversed;
-			vertexOut.position.z *= wInversed;
-			vertexOut.position.w = wInversed;
+	void Mesh::CullMeshlets(const Camera& camera, SoftwareFrame& frame) const
+	{
+		frame.visibleMeshlets.clear();
 
-			//set the normal of the vertex
-			vertexOut.normal = m_WorldMatrix.TransformVector(vertex.normal);
+		for (uint32_t instance{}; instance < GetAmountOfInstances(); ++instance)
+		{
+			const Matrix& worldMatrix{ m_InstanceWorldMatrices[instance] };
+
+			//culling happens in model space: the planes are transformed with the world matrix, so the meshlet bounds are used as they are
+			Vector4 frustumPlanes[6]{};
+			ExtractFrustumPlanes(worldMatrix * camera.viewMatrix * camera.projectionMatrix, frustumPlanes);
+			const Vector3 cameraPosition{ Matrix::Inverse(worldMatrix).TransformPoint(camera.origin) };
+
+			const LevelOfDetail& levelOfDetail{ m_LevelsOfDetail[SelectLevelOfDetail(camera, (worldMatrix.GetTranslation() - camera.origin).Magnitude())] };
 
-			//set the tangent of the vertex
-			vertexOut.tangent = m_WorldMatrix.TransformVector(vertex.tangent);
+			for (uint32_t meshletIndex{ levelOfDetail.firstMeshlet }; meshletIndex < levelOfDetail.firstMeshlet + levelOfDetail.amountOfMeshlets; ++meshletIndex)
+			{
+				const Meshlet& meshlet{ m_Meshlets[meshletIndex] };
 
-			//set the viewDirection of the vertex
-			vertexOut.viewDirection = camera.origin - m_WorldMatrix.TransformPoint(vertex.position);
+				const bool isOutsideFrustum
+				{
+					std::any_of(std::begin(frustumPlanes), std::end(frustumPlanes), [&](const Vector4& plane)
+					{
+						return Vector3::Dot(plane.GetXYZ(), meshlet.center) + plane.w < -meshlet.radius;
+					})
+				};
 
-			//set uv of the vertex
-			vertexOut.uv = vertex.uv;
+				if (isOutsideFrustum || IsMeshletCulledByFacing(meshlet, cameraPosition))
+					continue;
 
-			m_VerticesOut.emplace_back(vertexOut);
+				frame.visibleMeshlets.push_back({ instance, meshletIndex });
+			}
 		}
 	}
 
-	bool Mesh::IsTriangleInFrustum(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2)
+	bool Mesh::IsMeshletFacingAway(const Meshlet& meshlet, const Vector3& modelSpaceCameraPosition, bool flip) const
+	{
+		//the camera has to be behind the plane of every triangle, for any point of the bounding sphere (Kubisch 2018)
+		const Vector3 toCenter{ meshlet.center - modelSpaceCameraPosition };
+		const float axisDot{ Vector3::Dot(toCenter, meshlet.coneAxis) };
+
+		return (flip ? -axisDot : axisDot) >= meshlet.coneCutoff * toCenter.Magnitude() + meshlet.radius;
+	}
+
+	void Mesh::VertexTransformationFunction(const Camera& camera, SoftwareFrame& frame) const
 	{
-		if (v0.position.x < -1.f || v0.position.x > 1.f
-			|| v1.position.x < -1.f || v1.position.x > 1.f
-			|| v2.position.x < -1.f || v2.position.x > 1.f)
+		std::fill(frame.isVertexTransformed.begin(), frame.isVertexTransformed.end(), uint8_t{});
+
+		const size_t amountOfVertices{ GetAmountOfVertices() };
+
+		//the visible meshlets are sorted on their instance, the vertices of an instance are transformed once all of its meshlets are gathered
+		uint32_t instance{ UINT32_MAX };
+		uint8_t* pIsInstanceVertexTransformed{};
+		frame.verticesToTransform.clear();
+
+		const auto transformInstanceVertices = [&]()
+		{
+			if (instance == UINT32_MAX)
+				return;
+
+			const Matrix& worldMatrix{ m_InstanceWorldMatrices[instance] };
+			TransformVertices(frame.verticesToTransform, worldMatrix, worldMatrix * camera.viewMatrix * camera.projectionMatrix, camera.origin, frame.verticesOut.data() + instance * amountOfVertices);
+			frame.verticesToTransform.clear();
+		};
+
+		//meshlets share vertices at their borders, those are transformed once per instance
+		for (const VisibleMeshlet& visibleMeshlet : frame.visibleMeshlets)
+		{
+			if (visibleMeshlet.instance != instance)
+			{
+				transformInstanceVertices();
+				instance = visibleMeshlet.instance;
+				pIsInstanceVertexTransformed = frame.isVertexTransformed.data() + instance * amountOfVertices;
+			}
+
+			const Meshlet& meshlet{ m_Meshlets[visibleMeshlet.meshlet] };
+			const uint32_t endIndex{ (meshlet.firstTriangle + meshlet.amountOfTriangles) * 3 };
+
+			for (uint32_t index{ meshlet.firstTriangle * 3 }; index < endIndex; ++index)
+			{
+				const uint32_t vertexIndex{ m_Indices[index] };
+
+				if (pIsInstanceVertexTransformed[vertexIndex])
+					continue;
+
+				pIsInstanceVertexTransformed[vertexIndex] = 1;
+				frame.verticesToTransform.push_back(vertexIndex);
+			}
+		}
+
+		transformInstanceVertices();
+	}
+
+	void Mesh::TransformVertices(const std::vector<uint32_t>& vertexIndices, const Matrix& worldMatrix, const Matrix& worldViewProjectionMatrix, const Vector3& cameraOrigin, Vertex_Out* pVerticesOut) const
+	{
+		size_t vertex{};
+
+#ifdef MESH_USE_SSE2
+		//every register holds one component of four vertices, the operations are the ones of TransformVertex in the same order
+		const __m128 half{ _mm_set1_ps(0.5f) };
+		const __m128 one{ _mm_set1_ps(1.f) };
+		const __m128 windowWidth{ _mm_set1_ps(m_WindowWidth) };
+		const __m128 windowHeight{ _mm_set1_ps(m_WindowHeight) };
+		const Matrix4x4 world{ BroadcastMatrix(worldMatrix) };
+		const Matrix4x4 worldViewProjection{ BroadcastMatrix(worldViewProjectionMatrix) };
+
+		for (; vertex + 4 <= vertexIndices.size(); vertex += 4)
+		{
+			//the full vertices are read where they are, only compact ones are decompressed to a copy
+			Vertex_In decompressedVertices[4]{};
+			const Vertex_In* pVerticesIn[4]{};
+
+			for (size_t lane{}; lane < 4; ++lane)
+			{
+				if (m_VertexFormat == VertexFormat::compact)
+				{
+					decompressedVertices[lane] = GetVertexIn(vertexIndices[vertex + lane]);
+					pVerticesIn[lane] = &decompressedVertices[lane];
+				}
+				else
+				{
+					pVerticesIn[lane] = &m_Vertices[vertexIndices[vertex + lane]];
+				}
+			}
+
+			const Vertex_In& vertex0{ *pVerticesIn[0] };
+			const Vertex_In& vertex1{ *pVerticesIn[1] };
+			const Vertex_In& vertex2{ *pVerticesIn[2] };
+			const Vertex_In& vertex3{ *pVerticesIn[3] };
+
+			const Vector3x4 positions{ LoadVector3x4(vertex0.position, vertex1.position, vertex2.position, vertex3.position) };
+			const Vector3x4 normals{ LoadVector3x4(vertex0.normal, vertex1.normal, vertex2.normal, vertex3.normal) };
+			const Vector3x4 tangents{ LoadVector3x4(vertex0.tangent, vertex1.tangent, vertex2.tangent, vertex3.tangent) };
+			const __m128 tangentSigns{ _mm_setr_ps(vertex0.tangentSign, vertex1.tangentSign, vertex2.tangentSign, vertex3.tangentSign) };
+
+			//perspective divide and to screen space
+			const Vector4x4 projectedPositions{ TransformPoint4x4(worldViewProjection, positions) };
+			const __m128 wInversed{ _mm_div_ps(one, projectedPositions.w) };
+
+			const Vector4x4 screenPositions
+			{
+				_mm_mul_ps(_mm_mul_ps(half, _mm_add_ps(_mm_mul_ps(projectedPositions.x, wInversed), one)), windowWidth),
+				_mm_mul_ps(_mm_mul_ps(half, _mm_sub_ps(one, _mm_mul_ps(projectedPositions.y, wInversed))), windowHeight),
+				_mm_mul_ps(projectedPositions.z, wInversed),
+				wInversed
+			};
+
+			const Vector3x4 binormals{ MultiplyVector3x4(CrossVector3x4(normals, tangents), tangentSigns) };
+			const Vector3x4 worldPositions{ TransformPoint3x4(world, positions) };
+			const Vector3x4 cameraOrigins{ _mm_set1_ps(cameraOrigin.x), _mm_set1_ps(cameraOrigin.y), _mm_set1_ps(cameraOrigin.z) };
+
+			Vector4 positionsOut[4]{};
+			Vector3 normalsOut[4]{};
+			Vector3 tangentsOut[4]{};
+			Vector3 binormalsOut[4]{};
+			Vector3 viewDirectionsOut[4]{};
+
+			StoreVector4x4(screenPositions, positionsOut);
+			StoreVector3x4(TransformVector3x4(world, normals), normalsOut);
+			StoreVector3x4(TransformVector3x4(world, tangents), tangentsOut);
+			StoreVector3x4(TransformVector3x4(world, binormals), binormalsOut);
+			StoreVector3x4(SubtractVector3x4(cameraOrigins, worldPositions), viewDirectionsOut);
+
+			for (size_t lane{}; lane < 4; ++lane)
+			{
+				Vertex_Out& vertexOut{ pVerticesOut[vertexIndices[vertex + lane]] };
+				vertexOut.position = positionsOut[lane];
+				vertexOut.uv = pVerticesIn[lane]->uv;
+				vertexOut.normal = normalsOut[lane];
+				vertexOut.tangent = tangentsOut[lane];
+				vertexOut.binormal = binormalsOut[lane];
+				vertexOut.viewDirection = viewDirectionsOut[lane];
+			}
+		}
+#endif
+
+		//the vertices that don't fill a batch of four
+		for (; vertex < vertexIndices.size(); ++vertex)
+		{
+			pVerticesOut[vertexIndices[vertex]] = TransformVertex(GetVertexIn(vertexIndices[vertex]), worldMatrix, worldViewProjectionMatrix, cameraOrigin);
+		}
+	}
+
+	Mesh::Vertex_Out Mesh::TransformVertex(const Vertex_In& vertex, const Matrix& worldMatrix, const Matrix& worldViewProjectionMatrix, const Vector3& cameraOrigin) const
+	{
+		Vertex_Out vertexOut{};
+
+		vertexOut.position = worldViewProjectionMatrix.TransformPoint({ vertex.position.x, vertex.position.y, vertex.position.z, 0 });
+
+		//perspective divide
+		const float wInversed{ 1.f / vertexOut.position.w };
+		vertexOut.position.x *= wInversed;
+		vertexOut.position.y *= wInversed;
+		vertexOut.position.z *= wInversed;
+		vertexOut.position.w = wInversed;
+
+		//to screen space here and not per triangle, the vertices are shared between triangles
+		vertexOut.position.x = 0.5f * (vertexOut.position.x + 1.f) * m_WindowWidth;
+		vertexOut.position.y = 0.5f * (1.f - vertexOut.position.y) * m_WindowHeight;
+
+		//set the normal of the vertex
+		vertexOut.normal = worldMatrix.TransformVector(vertex.normal);
+
+		//set the tangent of the vertex
+		vertexOut.tangent = worldMatrix.TransformVector(vertex.tangent);
+		vertexOut.binormal = worldMatrix.TransformVector(Vector3::Cross(vertex.normal, vertex.tangent) * vertex.tangentSign);
+
+		//set the viewDirection of the vertex
+		vertexOut.viewDirection = cameraOrigin - worldMatrix.TransformPoint(vertex.position);
+
+		//set uv of the vertex
+		vertexOut.uv = vertex.uv;
+
+		return vertexOut;
+	}
+
+	Mesh::Vertex_In Mesh::GetVertexIn(uint32_t vertexIndex) const
+	{
+		if (m_VertexFormat == VertexFormat::compact)
+			return VertexCompression::DecompressVertex(m_CompactVertices[vertexIndex], m_BoundsMin, m_BoundsExtent);
+
+		return m_Vertices[vertexIndex];
+	}
+
+	bool Mesh::IsTriangleInFrustum(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2) const
+	{
+		if (v0.position.x < 0.f || v0.position.x > m_WindowWidth
+			|| v1.position.x < 0.f || v1.position.x > m_WindowWidth
+			|| v2.position.x < 0.f || v2.position.x > m_WindowWidth)
 			return false;
 		
-		if (v0.position.y < -1.f || v0.position.y > 1.f
-			|| v1.position.y < -1.f || v1.position.y > 1.f
-			|| v2.position.y < -1.f || v2.position.y > 1.f)
+		if (v0.position.y < 0.f || v0.position.y > m_WindowHeight
+			|| v1.position.y < 0.f || v1.position.y > m_WindowHeight
+			|| v2.position.y < 0.f || v2.position.y > m_WindowHeight)
 			return false;
 
 		if (v0.position.z < 0.f || v0.position.z > 1.f
@@ -136,18 +963,6 @@ namespace dae
 
 		return true;
 	}
-
-	void Mesh::TransformVerticesToScreenSpace(Vertex_Out& v0, Vertex_Out& v1, Vertex_Out& v2)
-	{
-		v0.position.x = 0.5f * (v0.position.x + 1.f) * m_WindowWidth;
-		v0.position.y = 0.5f * (1.f - v0.position.y) * m_WindowHeight;
-
-		v1.position.x = 0.5f * (v1.position.x + 1.f) * m_WindowWidth;
-		v1.position.y = 0.5f * (1.f - v1.position.y) * m_WindowHeight;
-
-		v2.position.x = 0.5f * (v2.position.x + 1.f) * m_WindowWidth;
-		v2.position.y = 0.5f * (1.f - v2.position.y) * m_WindowHeight;
-	}
 	
 	void Mesh::CalculateBoundingBox(const Vector2& v0, const Vector2& v1, const Vector2& v2, Vector2& min, Vector2& max) const
 	{
@@ -164,6 +979,95 @@ namespace dae
 		max.y = std::min(max.y, m_WindowHeight);
 	}
 
+	void Mesh::BinTriangle(SoftwareFrame& frame, uint32_t instance, uint32_t triangleIndex, float triangleArea) const
+	{
+		const uint32_t index{ triangleIndex * 3 };
+		const Vertex_Out& vertex0{ GetVertexOut(frame, instance, index) };
+		const Vertex_Out& vertex1{ GetVertexOut(frame, instance, index + 1) };
+		const Vertex_Out& vertex2{ GetVertexOut(frame, instance, index + 2) };
+
+		Vector2 min{};
+		Vector2 max{};
+
+		CalculateBoundingBox(vertex0.position.GetXY(), vertex1.position.GetXY(), vertex2.position.GetXY(), min, max);
+
+		//same pixel range as the loops in RenderTriangle
+		const int firstPixelX{ static_cast<int>(min.x) };
+		const int firstPixelY{ static_cast<int>(min.y) };
+		const int lastPixelX{ std::min(static_cast<int>(std::ceil(max.x)) - 1, static_cast<int>(m_WindowWidth) - 1) };
+		const int lastPixelY{ std::min(static_cast<int>(std::ceil(max.y)) - 1, static_cast<int>(m_WindowHeight) - 1) };
+
+		if (lastPixelX < firstPixelX || lastPixelY < firstPixelY)
+			return;
+
+		const uint32_t instanceTriangleIndex{ instance * GetAmountOfTriangles() + triangleIndex };
+		frame.triangleAreas[instanceTriangleIndex] = triangleArea;
+
+		for (int tileY{ firstPixelY / m_TileSize }; tileY <= lastPixelY / m_TileSize; ++tileY)
+		{
+			for (int tileX{ firstPixelX / m_TileSize }; tileX <= lastPixelX / m_TileSize; ++tileX)
+			{
+				frame.tileBins[tileY * m_AmountOfTilesX + tileX].push_back(instanceTriangleIndex);
+			}
+		}
+	}
+
+	void Mesh::RasterizeSoftwareFrame(ThreadPool* pThreadPool, uint32_t frameIndex, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels)
+	{
+		const SoftwareFrame& frame{ m_SoftwareFrames[frameIndex] };
+
+
+		//longest processing time first: tiles are sorted on what they cost last frame, tiles without triangles are skipped
+		m_TileOrder.clear();
+
+		for (uint32_t tileIndex{}; tileIndex < frame.tileBins.size(); ++tileIndex)
+		{
+			if (frame.tileBins[tileIndex].empty())
+				m_TileCosts[tileIndex] = 0;
+			else
+				m_TileOrder.push_back(tileIndex);
+		}
+
+		std::sort(m_TileOrder.begin(), m_TileOrder.end(), [&](uint32_t tileIndex0, uint32_t tileIndex1)
+			{
+				//a tile that was empty last frame has no cost yet, the amount of triangles is the best guess then
+				if (m_TileCosts[tileIndex0] != m_TileCosts[tileIndex1])
+					return m_TileCosts[tileIndex0] > m_TileCosts[tileIndex1];
+
+				return frame.tileBins[tileIndex0].size() > frame.tileBins[tileIndex1].size();
+			});
+
+		const uint32_t amountOfTriangles{ GetAmountOfTriangles() };
+
+		pThreadPool->ParallelFor(m_TileOrder, [&](uint32_t tileIndex)
+			{
+				const uint64_t startTicks{ SDL_GetPerformanceCounter() };
+
+				const Vector2 tileMin
+				{
+					static_cast<float>(tileIndex % m_AmountOfTilesX * m_TileSize),
+					static_cast<float>(tileIndex / m_AmountOfTilesX * m_TileSize)
+				};
+
+				const Vector2 tileMax
+				{
+					std::min(tileMin.x + m_TileSize, m_WindowWidth),
+					std::min(tileMin.y + m_TileSize, m_WindowHeight)
+				};
+
+				for (const uint32_t instanceTriangleIndex : frame.tileBins[tileIndex])
+				{
+					const uint32_t instance{ instanceTriangleIndex / amountOfTriangles };
+					const uint32_t index{ instanceTriangleIndex % amountOfTriangles * 3 };
+
+					RenderTriangle(instanceTriangleIndex, GetVertexOut(frame, instance, index), GetVertexOut(frame, instance, index + 1), GetVertexOut(frame, instance, index + 2),
+						frame.triangleAreas[instanceTriangleIndex], pDepthBufferPixels, pBackBuffer, pBackBufferPixels, tileMin, tileMax);
+				}
+
+				m_TileCosts[tileIndex] = SDL_GetPerformanceCounter() - startTicks;
+			});
+	}
+
 	void Mesh::VisualizeBoundingBox(const Vector2& min, const Vector2& max, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const
 	{
 		ColorRGBA color{ 1.f, 1.f, 1.f };
@@ -268,6 +1172,13 @@ namespace dae
 					+ v2.tangent * w2 * v2.position.w}.Normalized()
 		};
 
+		pixel.binormal =
+		{
+			Vector3{v0.binormal * w0 * v0.position.w
+					+ v1.binormal * w1 * v1.position.w
+					+ v2.binormal * w2 * v2.position.w}.Normalized()
+		};
+
 		pixel.viewDirection =
 		{
 			Vector3{v0.viewDirection * w0 * v0.position.w
@@ -278,6 +1189,32 @@ namespace dae
 		return pixel;
 	}
 
+	Vector2 Mesh::InterpolateUV(const Vector2& pixelPos, const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, float area) const
+	{
+		float w0{};
+		float w1{};
+		float w2{};
+
+		CalculateWeights(pixelPos, w0, w1, w2, { v0.position.x, v0.position.y }, { v1.position.x, v1.position.y }, { v2.position.x, v2.position.y }, area);
+
+		const float interpolatedCameraSpaceZ{ 1.f / (w0 * v0.position.w + w1 * v1.position.w + w2 * v2.position.w) };
+
+		return interpolatedCameraSpaceZ * (v0.uv * w0 * v0.position.w + v1.uv * w1 * v1.position.w + v2.uv * w2 * v2.position.w);
+	}
+
+	Mesh::UVDerivatives Mesh::CalculateUVDerivatives(const Vector2& pixelPos, const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, float area) const
+	{
+		//the weights are extrapolated for the quad pixels that lie outside of the triangle
+		const Vector2 quadPos{ std::floor(pixelPos.x / 2.f) * 2.f, std::floor(pixelPos.y / 2.f) * 2.f };
+		const Vector2 uv{ InterpolateUV(quadPos, v0, v1, v2, area) };
+
+		return
+		{
+			InterpolateUV({ quadPos.x + 1.f, quadPos.y }, v0, v1, v2, area) - uv,
+			InterpolateUV({ quadPos.x, quadPos.y + 1.f }, v0, v1, v2, area) - uv
+		};
+	}
+
 	void Mesh::MapPixelToBackBuffer(int pixelIndex, const ColorRGBA& color, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const
 	{
 		pBackBufferPixels[pixelIndex] = SDL_MapRGB(pBackBuffer->format,
@@ -1,10 +1,13 @@
 #pragma once
 #include "pch.h"
 #include "Effect.h"
+#include <span>
 
 namespace dae
 {
 	class Texture;
+	class ThreadPool;
+	class MappedFile;
 	struct Camera;
 
 	class Mesh
@@ -16,6 +19,43 @@ namespace dae
 			Vector2 uv;
 			Vector3 normal;
 			Vector3 tangent;
+			float tangentSign; //-1 where the uvs are mirrored, the binormal is tangentSign * cross(normal, tangent)
+		};
+
+		//20 instead of 48 bytes, see VertexCompression
+		struct CompactVertex_In
+		{
+			uint16_t position[4]; //unorm16 within the bounds of the mesh, the fourth one is the tangent sign: 0 for -1 and 65535 for 1
+			uint16_t uv[2]; //half floats
+			int16_t normal[2]; //octahedral, snorm16
+			int16_t tangent[2]; //octahedral, snorm16
+		};
+
+		//a run of consecutive triangles in the index buffer that is culled as a whole, in model space
+		struct Meshlet
+		{
+			uint32_t firstTriangle;
+			uint32_t amountOfTriangles;
+			Vector3 center; //bounding sphere of the vertices
+			float radius;
+			Vector3 coneAxis; //average normal of the triangles, pointing to the side they are seen from
+			float coneCutoff; //sine of the half angle of the cone around coneAxis that holds every normal, 1 if it can't be culled
+		};
+
+		//a simplified version of the mesh, a run of the index buffer with the meshlets that cover it
+		struct LevelOfDetail
+		{
+			uint32_t firstIndex;
+			uint32_t amountOfIndices;
+			uint32_t firstMeshlet;
+			uint32_t amountOfMeshlets;
+			float error; //square root of the largest quadric cost of the simplification (an area weighted distance to the planes of the full mesh) in model space, 0 for the full mesh
+		};
+
+		enum class VertexFormat
+		{
+			full,
+			compact
 		};
 
 		struct Vertex_Out
@@ -24,10 +64,14 @@ namespace dae
 			Vector2 uv;
 			Vector3 normal;
 			Vector3 tangent;
+			Vector3 binormal;
 			Vector3 viewDirection;
 		};
 
-		Mesh(ID3D11Device* pDevice, const std::string& modelFilePath, float windowWidth, float windowHeight);
+		//the triangles are reordered for the vertex cache, unless the order matters (blending without sorting)
+		//the compact vertex format needs an effect with a matching input layout
+		//pDevice can be nullptr, then there are no buffers to render the mesh with the hardware path (used to cook the cache file)
+		Mesh(ID3D11Device* pDevice, const std::string& modelFilePath, float windowWidth, float windowHeight, VertexFormat vertexFormat = VertexFormat::full, bool keepTriangleOrder = false);
 		virtual ~Mesh();
 
 		Mesh(const Mesh& other) = delete;
@@ -36,14 +80,73 @@ namespace dae
 		Mesh& operator=(Mesh&& other) = delete;
 
 		virtual void RenderHardware(ID3D11DeviceContext* pDeviceContext) const = 0;
-		virtual void RenderSoftware(const Camera& camera, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) = 0;
+		//geometry stage: vertex transformation, culling and binning into the screen tiles
+		//every frame index has its own data, so the next frame can be prepared while the current one is rasterized
+		void PrepareSoftwareFrame(const Camera& camera, uint32_t frameIndex);
+		void RasterizeSoftwareFrame(ThreadPool* pThreadPool, uint32_t frameIndex, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels);
 		void ToggleBoundingBoxVisualization();
 		void RotateYCW(float angle); //CW = clockwise
+		//every instance shares the vertices and indices and is placed by its transform after the world matrix of the mesh,
+		//so the instances turn around their own origin, the transforms may only rotate and translate (asserted):
+		//the normals, the levels of detail and the bounding radius aren't scaled
+		//a mesh starts with one instance at the origin of the world matrix
+		void SetInstanceTransforms(ID3D11Device* pDevice, const std::vector<Matrix>& instanceTransforms);
+		uint32_t GetAmountOfInstances() const { return static_cast<uint32_t>(m_InstanceWorldMatrices.size()); }
+		//world matrix of the mesh followed by the transform of the instance
+		const Matrix& GetInstanceWorldMatrix(uint32_t instance) const { return m_InstanceWorldMatrices[instance]; }
+		//picks the level of detail the hardware path draws for all instances, the one of the nearest instance
+		//the software path picks its own per frame and instance
+		void UpdateLevelOfDetail(const Camera& camera);
+		uint32_t GetLevelOfDetail() const { return m_LevelOfDetail; }
 		const Matrix& GetWorldMatrix() const { return m_WorldMatrix; }
 		float GetRotationSpeed() const { return m_RotationSpeed; }
 		float GetRotationAngle() const { return m_RotationAngle; }
+		//radius of the sphere around the model origin that holds all vertices
+		float GetBoundingRadius() const { return m_BoundingRadius; }
+		//distance from position to the origin of the nearest instance
+		float CalculateNearestInstanceDistance(const Vector3& position) const;
+		VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+		uint32_t GetVertexSize() const;
+		//the file the parsed model is cached in, named after the obj file and the settings, empty when the obj file can't be opened
+		static std::string GetCachePath(const std::string& modelFilePath, VertexFormat vertexFormat, bool keepTriangleOrder);
+		//a model that is too big to parse at once is cooked in parts of at most maxVerticesPerPart vertices (Utils::ParseOBJInParts),
+		//the part list names the cache file of every part, one per line, and is written after the last part
+		//only the AssetCooker writes parts, nothing loads them yet: the renderer still loads a model as one mesh
+		static std::string GetPartListPath(const std::string& modelFilePath, VertexFormat vertexFormat, bool keepTriangleOrder, uint32_t maxVerticesPerPart);
+		static std::string GetPartCachePath(const std::string& partListPath, uint32_t part);
+
+		static constexpr uint32_t m_AmountOfSoftwareFrames{ 2 };
 
 	protected:
+		//a part of a model, the vertices and indices are welded but not optimized yet, cachePath can be empty
+		Mesh(ID3D11Device* pDevice, const std::string& modelName, std::vector<Vertex_In>&& vertices, std::vector<uint32_t>&& indices, const std::string& cachePath, float windowWidth, float windowHeight, VertexFormat vertexFormat = VertexFormat::full, bool keepTriangleOrder = false);
+
+		struct VisibleMeshlet
+		{
+			uint32_t instance;
+			uint32_t meshlet;
+		};
+
+		struct SoftwareFrame
+		{
+			//only the vertices of the visible meshlets are transformed, the others keep stale data
+			//every instance has its own run of vertices, and of triangles in the bins (instance * amount of triangles + triangle)
+			std::vector<Vertex_Out> verticesOut;
+			std::vector<uint8_t> isVertexTransformed;
+			//the vertices of the visible meshlets of one instance, gathered first so they are transformed in batches
+			std::vector<uint32_t> verticesToTransform;
+			std::vector<VisibleMeshlet> visibleMeshlets;
+			std::vector<std::vector<uint32_t>> tileBins;
+			std::vector<float> triangleAreas;
+		};
+
+		//change in uv from one pixel to the next one in x and y, used to pick the mip level
+		struct UVDerivatives
+		{
+			Vector2 ddx;
+			Vector2 ddy;
+		};
+
 		Matrix m_WorldMatrix
 		{
 			{1, 0, 0, 0},
@@ -54,31 +157,105 @@ namespace dae
 
 		ID3D11Buffer* m_pVertexBuffer{};
 		ID3D11Buffer* m_pIndexBuffer{};
+		//the world matrix of every instance, written before every draw because the world matrix of the mesh changes every frame
+		ID3D11Buffer* m_pInstanceBuffer{};
+
+		std::vector<Matrix> m_InstanceTransforms;
+		std::vector<Matrix> m_InstanceWorldMatrices;
 
 		uint32_t m_AmountOfIndices{};
 
-		std::vector<Vertex_In> m_Vertices;
-		std::vector<Vertex_Out> m_VerticesOut;
-		std::vector<uint32_t> m_Indices;
+		//views of the vertices and indices, they are in the storage vectors when the model was parsed or in the mapped cache file
+		//only the vertices of m_VertexFormat are kept
+		std::span<const Vertex_In> m_Vertices;
+		std::span<const CompactVertex_In> m_CompactVertices;
+		std::span<const uint32_t> m_Indices;
+		std::span<const Meshlet> m_Meshlets;
+		std::span<const LevelOfDetail> m_LevelsOfDetail;
+		std::vector<Vertex_In> m_VertexStorage;
+		std::vector<CompactVertex_In> m_CompactVertexStorage;
+		std::vector<uint32_t> m_IndexStorage;
+		std::vector<Meshlet> m_MeshletStorage;
+		std::vector<LevelOfDetail> m_LevelOfDetailStorage;
+		MappedFile* m_pCacheFile{};
 
 		float m_WindowWidth;
 		float m_WindowHeight;
 
+		VertexFormat m_VertexFormat;
+		//axis aligned box around the vertices, the compact positions are relative to it
+		Vector3 m_BoundsMin{};
+		Vector3 m_BoundsExtent{};
+		float m_BoundingRadius{};
+
+		//the finest level is 0, a level is only used while its error is smaller than m_MaxScreenSpaceError pixels
+		static constexpr uint32_t m_MaxLevelsOfDetail{ 4 };
+		static constexpr float m_MaxScreenSpaceError{ 1.f };
+		uint32_t m_LevelOfDetail{};
+
 		bool m_VisualzeBoundingBox{};
 
-		void VertexTransformationFunction(const Camera& camera);
-		//vertices have to be in NDC space
-		bool IsTriangleInFrustum(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2);
-		void TransformVerticesToScreenSpace(Vertex_Out& v0, Vertex_Out& v1, Vertex_Out& v2);
+		//the screen is split in tiles that are rasterized in parallel, every tile renders its triangles in submission order
+		//so each pixel is only touched by one thread and the result does not depend on the amount of threads
+		static constexpr int m_TileSize{ 32 };
+		int m_AmountOfTilesX{};
+		int m_AmountOfTilesY{};
+		SoftwareFrame m_SoftwareFrames[m_AmountOfSoftwareFrames];
+		//render time of every tile in the previous frame, the most expensive tiles are scheduled first
+		std::vector<uint64_t> m_TileCosts;
+		std::vector<uint32_t> m_TileOrder;
+
+		//the parsed model is cached on disk, the next runs map it instead of parsing the obj file
+		bool LoadFromCache(const std::string& cachePath);
+		void SaveToCache(const std::string& cachePath) const;
+		//bounds, levels of detail, meshlets and vertex order of the parsed vertices and indices in the storage
+		void BuildModel(const std::string& modelName, bool keepTriangleOrder);
+		//tiles of the software path and the buffers of the hardware path (none without a device)
+		void CreateResources(ID3D11Device* pDevice);
+		//simplifies the parsed indices into the levels of detail and builds the meshlets of every level
+		void BuildLevelsOfDetail(bool keepTriangleOrder);
+		//distance is from the camera to the origin of the instance
+		uint32_t SelectLevelOfDetail(const Camera& camera, float distance) const;
+		void UpdateInstanceWorldMatrices();
+		//creates the instance buffer for the current amount of instances
+		void CreateInstanceBuffer(ID3D11Device* pDevice);
+		//copies the instance world matrices to the instance buffer and binds it as the second vertex buffer
+		void SetInstanceBuffer(ID3D11DeviceContext* pDeviceContext) const;
+		size_t GetAmountOfVertices() const { return m_VertexFormat == VertexFormat::compact ? m_CompactVertices.size() : m_Vertices.size(); }
+		uint32_t GetAmountOfTriangles() const { return static_cast<uint32_t>(m_Indices.size() / 3); }
+		//the transformed vertex at an index of the index buffer, for an instance
+		const Vertex_Out& GetVertexOut(const SoftwareFrame& frame, uint32_t instance, uint32_t index) const { return frame.verticesOut[instance * GetAmountOfVertices() + m_Indices[index]]; }
+
+		//frustum and normal cone culling of the meshlets of every instance, in the level of detail of the instance, before any of their vertices are transformed
+		void CullMeshlets(const Camera& camera, SoftwareFrame& frame) const;
+		//true when every triangle of the meshlet faces away from the camera, flip to test if they all face towards it
+		bool IsMeshletFacingAway(const Meshlet& meshlet, const Vector3& modelSpaceCameraPosition, bool flip) const;
+		virtual bool IsMeshletCulledByFacing(const Meshlet& meshlet, const Vector3& modelSpaceCameraPosition) const { return false; }
+		//transforms the vertices of the visible meshlets, once for every instance they are visible in
+		void VertexTransformationFunction(const Camera& camera, SoftwareFrame& frame) const;
+		//four vertices at a time with SSE2, the results are the same as the ones of TransformVertex
+		void TransformVertices(const std::vector<uint32_t>& vertexIndices, const Matrix& worldMatrix, const Matrix& worldViewProjectionMatrix, const Vector3& cameraOrigin, Vertex_Out* pVerticesOut) const;
+		Vertex_Out TransformVertex(const Vertex_In& vertex, const Matrix& worldMatrix, const Matrix& worldViewProjectionMatrix, const Vector3& cameraOrigin) const;
+		//decompresses the vertex in the compact format
+		Vertex_In GetVertexIn(uint32_t vertexIndex) const;
+		//vertices have to be in screen space
+		bool IsTriangleInFrustum(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2) const;
 		void CalculateBoundingBox(const Vector2& v0, const Vector2& v1, const Vector2& v2, Vector2& min, Vector2& max) const;
+		//culls the transformed triangles of the visible meshlets and calls BinTriangle for the ones that have to be rendered
+		virtual void BinTriangles(SoftwareFrame& frame) = 0;
+		//vertices have to be in screen space
+		void BinTriangle(SoftwareFrame& frame, uint32_t instance, uint32_t triangleIndex, float triangleArea) const;
 		void VisualizeBoundingBox(const Vector2& min, const Vector2& max, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const;
 		bool IsPixelInTriange(const Vector2& v0, const Vector2& v1, const Vector2& v2, const Vector2& pixelPos) const;
 		void CalculateWeights(const Vector2& pixelPos, float& w0, float& w1, float& w2, const Vector2& v0, const Vector2& v1, const Vector2& v2, float area) const;
 		float CalculateDepthInterpolated(float w0, float w1, float w2, float v0Depth, float v1Depth, float v2Depth) const;
 		Vertex_Out CalculatePixel(const Vector2& pixelPos, float w0, float w1, float w2, const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, float depthInterpolated) const;
-		virtual void RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const = 0;
+		virtual void RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels, const Vector2& tileMin, const Vector2& tileMax) const = 0;
 		virtual void RenderPixel(uint32_t pixelIndex, const Vertex_Out& triangleVertex0, const Vertex_Out& triangleVertex1, const Vertex_Out& triangleVertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const = 0;
-		virtual ColorRGBA ShadePixel(const Vertex_Out& vertex) const = 0;
+		Vector2 InterpolateUV(const Vector2& pixelPos, const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, float area) const;
+		//same for every pixel of a 2x2 quad, calculated with finite differences between its pixels like the GPU does
+		UVDerivatives CalculateUVDerivatives(const Vector2& pixelPos, const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, float area) const;
+		virtual ColorRGBA ShadePixel(const Vertex_Out& vertex, const UVDerivatives& uvDerivatives) const = 0;
 		void MapPixelToBackBuffer(int pixelIndex, const ColorRGBA& color, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const;
 
 	private:
@@ -0,0 +1,848 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+#include <numeric>
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		namespace
+		{
+			//for every vertex the first vertex with the same position
+			std::vector<uint32_t> BuildPositionRemap(const std::vector<Mesh::Vertex_In>& vertices)
+			{
+				std::vector<uint32_t> sortedVertices(vertices.size());
+				std::iota(sortedVertices.begin(), sortedVertices.end(), 0u);
+
+				const auto isLess = [&](uint32_t vertex0, uint32_t vertex1)
+				{
+					const Vector3& position0{ vertices[vertex0].position };
+					const Vector3& position1{ vertices[vertex1].position };
+
+					if (position0.x != position1.x)
+						return position0.x < position1.x;
+
+					if (position0.y != position1.y)
+						return position0.y < position1.y;
+
+					if (position0.z != position1.z)
+						return position0.z < position1.z;
+
+					return vertex0 < vertex1;
+				};
+
+				std::sort(sortedVertices.begin(), sortedVertices.end(), isLess);
+
+				std::vector<uint32_t> remap(vertices.size());
+
+				for (size_t sortedIndex{}; sortedIndex < sortedVertices.size(); ++sortedIndex)
+				{
+					const uint32_t vertex{ sortedVertices[sortedIndex] };
+					if (sortedIndex == 0)
+					{
+						remap[vertex] = vertex;
+						continue;
+					}
+
+					const uint32_t previousVertex{ sortedVertices[sortedIndex - 1] };
+					const Vector3& position{ vertices[vertex].position };
+					const Vector3& previousPosition{ vertices[previousVertex].position };
+					const bool isSamePosition{ position.x == previousPosition.x && position.y == previousPosition.y && position.z == previousPosition.z };
+
+					remap[vertex] = isSamePosition ? remap[previousVertex] : vertex;
+				}
+
+				return remap;
+			}
+
+			//unit normal on the side the triangle is visible from when back faces are culled
+			//zero for a degenerate triangle, that one is never rendered
+			Vector3 CalculateTriangleNormal(const std::vector<Mesh::Vertex_In>& vertices, const std::vector<uint32_t>& indices, uint32_t firstIndex)
+			{
+				const Vector3& v0{ vertices[indices[firstIndex]].position };
+				const Vector3& v1{ vertices[indices[firstIndex + 1]].position };
+				const Vector3& v2{ vertices[indices[firstIndex + 2]].position };
+
+				const Vector3 normal{ Vector3::Cross(v1 - v0, v2 - v0) };
+				const float length{ normal.Magnitude() };
+
+				if (length <= 0.f)
+					return {};
+
+				return normal / length;
+			}
+
+			void CalculateMeshletBounds(const std::vector<Mesh::Vertex_In>& vertices, const std::vector<uint32_t>& indices, Mesh::Meshlet& meshlet)
+			{
+				const uint32_t firstIndex{ meshlet.firstTriangle * 3 };
+				const uint32_t endIndex{ firstIndex + meshlet.amountOfTriangles * 3 };
+
+				//the sphere around the center of the bounding box, not the smallest one but close enough to cull with
+				Vector3 boundsMin{ vertices[indices[firstIndex]].position };
+				Vector3 boundsMax{ boundsMin };
+
+				for (uint32_t index{ firstIndex }; index < endIndex; ++index)
+				{
+					boundsMin = Vector3::Min(boundsMin, vertices[indices[index]].position);
+					boundsMax = Vector3::Max(boundsMax, vertices[indices[index]].position);
+				}
+
+				meshlet.center = (boundsMin + boundsMax) / 2.f;
+				meshlet.radius = 0.f;
+
+				for (uint32_t index{ firstIndex }; index < endIndex; ++index)
+				{
+					meshlet.radius = std::max(meshlet.radius, (vertices[indices[index]].position - meshlet.center).Magnitude());
+				}
+
+				std::vector<Vector3> normals{};
+				normals.reserve(meshlet.amountOfTriangles);
+				Vector3 normalSum{};
+
+				for (uint32_t index{ firstIndex }; index < endIndex; index += 3)
+				{
+					const Vector3 normal{ CalculateTriangleNormal(vertices, indices, index) };
+
+					if (normal.SqrMagnitude() == 0.f)
+						continue;
+
+					normals.push_back(normal);
+					normalSum += normal;
+				}
+
+				meshlet.coneAxis = {};
+				meshlet.coneCutoff = 1.f;
+
+				const float sumLength{ normalSum.Magnitude() };
+
+				if (normals.empty() || sumLength <= 0.f)
+					return;
+
+				meshlet.coneAxis = normalSum / sumLength;
+
+				float minimumDot{ 1.f };
+
+				for (const Vector3& normal : normals)
+				{
+					minimumDot = std::min(minimumDot, Vector3::Dot(normal, meshlet.coneAxis));
+				}
+
+				//a cone of 90 degrees or wider always has a triangle that faces the camera
+				if (minimumDot <= 0.f)
+					return;
+
+				meshlet.coneCutoff = std::sqrt(1.f - minimumDot * minimumDot);
+			}
+
+			//the sum of the squared distances to the planes of some triangles as a symmetric 4x4 matrix (Garland and Heckbert 1997)
+			//every plane is weighted by the area of its triangle, the weight sum turns the sum into an average
+			struct Quadric
+			{
+				double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+				double weight;
+
+				void AddPlane(const Vector3& normal, float distance, float planeWeight)
+				{
+					a00 += planeWeight * normal.x * normal.x;
+					a01 += planeWeight * normal.x * normal.y;
+					a02 += planeWeight * normal.x * normal.z;
+					a03 += planeWeight * normal.x * distance;
+					a11 += planeWeight * normal.y * normal.y;
+					a12 += planeWeight * normal.y * normal.z;
+					a13 += planeWeight * normal.y * distance;
+					a22 += planeWeight * normal.z * normal.z;
+					a23 += planeWeight * normal.z * distance;
+					a33 += planeWeight * distance * distance;
+					weight += planeWeight;
+				}
+
+				void Add(const Quadric& other)
+				{
+					a00 += other.a00;
+					a01 += other.a01;
+					a02 += other.a02;
+					a03 += other.a03;
+					a11 += other.a11;
+					a12 += other.a12;
+					a13 += other.a13;
+					a22 += other.a22;
+					a23 += other.a23;
+					a33 += other.a33;
+					weight += other.weight;
+				}
+
+				double Evaluate(const Vector3& position) const
+				{
+					if (weight <= 0.0)
+						return 0.0;
+
+					const double x{ position.x };
+					const double y{ position.y };
+					const double z{ position.z };
+
+					const double error
+					{
+						a00 * x * x + a11 * y * y + a22 * z * z + a33
+						+ 2.0 * (a01 * x * y + a02 * x * z + a03 * x + a12 * y * z + a13 * y + a23 * z)
+					};
+
+					//rounding can make the error of a position on all planes slightly negative
+					return std::max(error, 0.0) / weight;
+				}
+			};
+
+			uint64_t GetEdgeKey(uint32_t from, uint32_t to)
+			{
+				return (static_cast<uint64_t>(from) << 32) | to;
+			}
+		}
+
+		VertexTriangles BuildVertexTriangles(const std::vector<uint32_t>& indices, size_t amountOfVertices)
+		{
+			VertexTriangles vertexTriangles{};
+			vertexTriangles.offsets.resize(amountOfVertices + 1);
+			vertexTriangles.triangles.resize(indices.size());
+
+			for (const uint32_t index : indices)
+			{
+				++vertexTriangles.offsets[index + 1];
+			}
+
+			for (size_t vertex{}; vertex < amountOfVertices; ++vertex)
+			{
+				vertexTriangles.offsets[vertex + 1] += vertexTriangles.offsets[vertex];
+			}
+
+			std::vector<uint32_t> fillCounts(amountOfVertices);
+
+			for (size_t corner{}; corner < indices.size(); ++corner)
+			{
+				const uint32_t vertex{ indices[corner] };
+				vertexTriangles.triangles[vertexTriangles.offsets[vertex] + fillCounts[vertex]++] = static_cast<uint32_t>(corner / 3);
+			}
+
+			return vertexTriangles;
+		}
+
+		float CalculateACMR(const std::vector<uint32_t>& indices, size_t amountOfVertices, uint32_t cacheSize)
+		{
+			if (indices.empty())
+				return 0.f;
+
+			//a vertex is in the FIFO while less than cacheSize misses happened since it was added
+			std::vector<uint32_t> missTimes(amountOfVertices, 0);
+			uint32_t amountOfMisses{};
+
+			for (const uint32_t index : indices)
+			{
+				if (missTimes[index] == 0 || amountOfMisses - missTimes[index] >= cacheSize)
+				{
+					++amountOfMisses;
+					missTimes[index] = amountOfMisses;
+				}
+			}
+
+			return static_cast<float>(amountOfMisses) / (indices.size() / 3);
+		}
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t amountOfVertices, uint32_t cacheSize)
+		{
+			const size_t amountOfTriangles{ indices.size() / 3 };
+
+			if (amountOfTriangles == 0)
+				return;
+
+			const VertexTriangles vertexTriangles{ BuildVertexTriangles(indices, amountOfVertices) };
+
+			//triangles that still have to be emitted per vertex
+			std::vector<uint32_t> liveTriangles(amountOfVertices);
+
+			for (size_t vertex{}; vertex < amountOfVertices; ++vertex)
+			{
+				liveTriangles[vertex] = vertexTriangles.offsets[vertex + 1] - vertexTriangles.offsets[vertex];
+			}
+
+			std::vector<uint32_t> cacheTimes(amountOfVertices, 0);
+			std::vector<bool> isTriangleEmitted(amountOfTriangles, false);
+			//the vertices of the last emitted triangles, to continue from when a fan ends without a good next vertex
+			std::vector<uint32_t> deadEndStack{};
+			std::vector<uint32_t> candidates{};
+
+			std::vector<uint32_t> optimizedIndices{};
+			optimizedIndices.reserve(indices.size());
+
+			uint32_t time{ cacheSize + 1 };
+			uint32_t cursor{};
+			int64_t fanningVertex{ indices[0] };
+
+			while (fanningVertex >= 0)
+			{
+				candidates.clear();
+
+				//emit every triangle around the fanning vertex
+				for (uint32_t offset{ vertexTriangles.offsets[fanningVertex] }; offset < vertexTriangles.offsets[fanningVertex + 1]; ++offset)
+				{
+					const uint32_t triangle{ vertexTriangles.triangles[offset] };
+
+					if (isTriangleEmitted[triangle])
+						continue;
+
+					for (uint32_t corner{}; corner < 3; ++corner)
+					{
+						const uint32_t vertex{ indices[triangle * 3 + corner] };
+
+						optimizedIndices.push_back(vertex);
+						deadEndStack.push_back(vertex);
+						candidates.push_back(vertex);
+						--liveTriangles[vertex];
+
+						if (time - cacheTimes[vertex] > cacheSize)
+							cacheTimes[vertex] = time++;
+					}
+
+					isTriangleEmitted[triangle] = true;
+				}
+
+				//continue with the candidate that is still in the cache and will stay in it longest after its fan
+				fanningVertex = -1;
+				int64_t bestPriority{ -1 };
+
+				for (const uint32_t candidate : candidates)
+				{
+					if (liveTriangles[candidate] == 0)
+						continue;
+
+					int64_t priority{};
+
+					if (time - cacheTimes[candidate] + 2 * liveTriangles[candidate] <= cacheSize)
+						priority = time - cacheTimes[candidate];
+
+					if (priority > bestPriority)
+					{
+						bestPriority = priority;
+						fanningVertex = candidate;
+					}
+				}
+
+				if (fanningVertex >= 0)
+					continue;
+
+				//dead end: the most recently used vertex that has triangles left, else the next vertex in input order that has
+				while (!deadEndStack.empty())
+				{
+					const uint32_t vertex{ deadEndStack.back() };
+					deadEndStack.pop_back();
+
+					if (liveTriangles[vertex] > 0)
+					{
+						fanningVertex = vertex;
+						break;
+					}
+				}
+
+				while (fanningVertex < 0 && cursor < amountOfVertices)
+				{
+					if (liveTriangles[cursor] > 0)
+						fanningVertex = cursor;
+
+					++cursor;
+				}
+			}
+
+			indices = std::move(optimizedIndices);
+		}
+
+		void OptimizeVertexFetch(std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices)
+		{
+			constexpr uint32_t unusedVertex{ UINT32_MAX };
+			std::vector<uint32_t> remap(vertices.size(), unusedVertex);
+			std::vector<Mesh::Vertex_In> optimizedVertices{};
+			optimizedVertices.reserve(vertices.size());
+
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == unusedVertex)
+				{
+					remap[index] = static_cast<uint32_t>(optimizedVertices.size());
+					optimizedVertices.push_back(vertices[index]);
+				}
+
+				index = remap[index];
+			}
+
+			vertices = std::move(optimizedVertices);
+		}
+
+		std::vector<Mesh::Meshlet> BuildMeshlets(const std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices, bool keepTriangleOrder, uint32_t maxVertices, uint32_t maxTriangles)
+		{
+			std::vector<Mesh::Meshlet> meshlets{};
+			const uint32_t amountOfTriangles{ static_cast<uint32_t>(indices.size() / 3) };
+
+			if (amountOfTriangles == 0)
+				return meshlets;
+
+			//triangles are neighbours when they share a position, vertices are split along uv and normal seams
+			std::vector<uint32_t> positionIndices(indices.size());
+			const std::vector<uint32_t> positionRemap{ BuildPositionRemap(vertices) };
+
+			for (size_t index{}; index < indices.size(); ++index)
+			{
+				positionIndices[index] = positionRemap[indices[index]];
+			}
+
+			const VertexTriangles positionTriangles{ BuildVertexTriangles(positionIndices, vertices.size()) };
+			std::vector<Vector3> triangleNormals(amountOfTriangles);
+
+			for (uint32_t triangle{}; triangle < amountOfTriangles; ++triangle)
+			{
+				triangleNormals[triangle] = CalculateTriangleNormal(vertices, indices, triangle * 3);
+			}
+
+			std::vector<bool> isTriangleUsed(amountOfTriangles, false);
+			//the meshlet that last used every vertex, offset by one so 0 means none
+			std::vector<uint32_t> vertexMeshlets(vertices.size(), 0);
+			//triangles around the vertices of the current meshlet, the meshlet grows with one of them
+			std::vector<uint32_t> candidates{};
+
+			std::vector<uint32_t> meshletIndices{};
+			meshletIndices.reserve(indices.size());
+
+			Mesh::Meshlet meshlet{};
+			uint32_t amountOfMeshletVertices{};
+			Vector3 normalSum{};
+			uint32_t cursor{};
+
+			const auto countNewVertices = [&](uint32_t triangle)
+			{
+				uint32_t amountOfNewVertices{};
+
+				for (uint32_t corner{}; corner < 3; ++corner)
+				{
+					if (vertexMeshlets[indices[triangle * 3 + corner]] != meshlets.size() + 1)
+						++amountOfNewVertices;
+				}
+
+				return amountOfNewVertices;
+			};
+
+			while (true)
+			{
+				while (cursor < amountOfTriangles && isTriangleUsed[cursor])
+				{
+					++cursor;
+				}
+
+				int64_t nextTriangle{ -1 };
+
+				if (keepTriangleOrder)
+				{
+					if (cursor < amountOfTriangles)
+						nextTriangle = cursor;
+				}
+				else if (meshlet.amountOfTriangles < maxTriangles)
+				{
+					//the neighbour that adds the least vertices, of those the one that widens the normal cone least
+					const Vector3 coneAxis{ normalSum.Magnitude() > 0.f ? normalSum.Normalized() : Vector3{} };
+					float bestScore{ FLT_MAX };
+
+					for (const uint32_t candidate : candidates)
+					{
+						if (isTriangleUsed[candidate])
+							continue;
+
+						const uint32_t amountOfNewVertices{ countNewVertices(candidate) };
+
+						if (amountOfMeshletVertices + amountOfNewVertices > maxVertices)
+							continue;
+
+						//a degenerate triangle has no normal and fits in any meshlet
+						const bool isDegenerate{ triangleNormals[candidate].SqrMagnitude() == 0.f };
+						const float normalDot{ isDegenerate ? 1.f : Vector3::Dot(triangleNormals[candidate], coneAxis) };
+
+						if (normalDot < meshletMinimumNormalDot)
+							continue;
+
+						const float score{ amountOfNewVertices + meshletConeWeight * (1.f - normalDot) };
+
+						if (score < bestScore)
+						{
+							bestScore = score;
+							nextTriangle = candidate;
+						}
+					}
+				}
+
+				const bool fits
+				{
+					nextTriangle >= 0
+					&& meshlet.amountOfTriangles < maxTriangles
+					&& amountOfMeshletVertices + countNewVertices(static_cast<uint32_t>(nextTriangle)) <= maxVertices
+				};
+
+				if (!fits)
+				{
+					if (meshlet.amountOfTriangles > 0)
+					{
+						CalculateMeshletBounds(vertices, meshletIndices, meshlet);
+						meshlets.push_back(meshlet);
+
+						meshlet = Mesh::Meshlet{ static_cast<uint32_t>(meshletIndices.size() / 3) };
+						amountOfMeshletVertices = 0;
+						normalSum = {};
+						candidates.clear();
+					}
+
+					//no neighbour left, a new meshlet starts at the next triangle in index order
+					if (nextTriangle < 0)
+					{
+						if (cursor == amountOfTriangles)
+							break;
+
+						nextTriangle = cursor;
+					}
+				}
+
+				const uint32_t triangle{ static_cast<uint32_t>(nextTriangle) };
+
+				for (uint32_t corner{}; corner < 3; ++corner)
+				{
+					const uint32_t vertex{ indices[triangle * 3 + corner] };
+					meshletIndices.push_back(vertex);
+
+					if (vertexMeshlets[vertex] == meshlets.size() + 1)
+						continue;
+
+					vertexMeshlets[vertex] = static_cast<uint32_t>(meshlets.size() + 1);
+					++amountOfMeshletVertices;
+
+					if (keepTriangleOrder)
+						continue;
+
+					const uint32_t position{ positionRemap[vertex] };
+
+					for (uint32_t offset{ positionTriangles.offsets[position] }; offset < positionTriangles.offsets[position + 1]; ++offset)
+					{
+						if (!isTriangleUsed[positionTriangles.triangles[offset]])
+							candidates.push_back(positionTriangles.triangles[offset]);
+					}
+				}
+
+				isTriangleUsed[triangle] = true;
+				normalSum += triangleNormals[triangle];
+				++meshlet.amountOfTriangles;
+			}
+
+			//the meshlets are runs in the index buffer, so the triangles are put in meshlet order
+			indices = std::move(meshletIndices);
+
+			return meshlets;
+		}
+
+		std::vector<uint32_t> Simplify(const std::vector<Mesh::Vertex_In>& vertices, const std::vector<uint32_t>& indices, size_t targetAmountOfIndices, float& error)
+		{
+			error = 0.f;
+			std::vector<uint32_t> simplifiedIndices{ indices };
+
+			if (indices.size() <= targetAmountOfIndices)
+				return simplifiedIndices;
+
+			const size_t amountOfTriangles{ indices.size() / 3 };
+			const std::vector<uint32_t> positionRemap{ BuildPositionRemap(vertices) };
+
+			std::vector<bool> isTriangleRemoved(amountOfTriangles, false);
+			std::vector<uint32_t> positionIndices(indices.size());
+			std::vector<uint64_t> edges{};
+			edges.reserve(indices.size());
+
+			//the edges of the remaining triangles between positions, sorted so the opposite edge can be searched for
+			const auto buildEdges = [&]()
+			{
+				edges.clear();
+
+				for (size_t index{}; index < simplifiedIndices.size(); ++index)
+				{
+					positionIndices[index] = positionRemap[simplifiedIndices[index]];
+				}
+
+				for (size_t index{}; index < simplifiedIndices.size(); ++index)
+				{
+					if (isTriangleRemoved[index / 3])
+						continue;
+
+					const size_t nextIndex{ index % 3 == 2 ? index - 2 : index + 1 };
+					edges.push_back(GetEdgeKey(positionIndices[index], positionIndices[nextIndex]));
+				}
+
+				std::sort(edges.begin(), edges.end());
+			};
+
+			const auto countEdges = [&](uint32_t from, uint32_t to)
+			{
+				const auto range{ std::equal_range(edges.begin(), edges.end(), GetEdgeKey(from, to)) };
+				return range.second - range.first;
+			};
+
+			//an edge without an opposite edge is on the border of the mesh, a position on it may only move along the border
+			//positions on edges that more than two triangles share or where borders meet stay where they are
+			std::vector<bool> isPositionLocked(vertices.size(), false);
+			std::vector<bool> isPositionOnBorder(vertices.size(), false);
+			std::vector<uint32_t> amountOfBorderEdges(vertices.size(), 0);
+			std::vector<Quadric> quadrics(vertices.size(), Quadric{});
+
+			buildEdges();
+
+			for (size_t index{}; index < indices.size(); ++index)
+			{
+				const size_t nextIndex{ index % 3 == 2 ? index - 2 : index + 1 };
+				const uint32_t position{ positionIndices[index] };
+				const uint32_t nextPosition{ positionIndices[nextIndex] };
+				const auto amountOfOppositeEdges{ countEdges(nextPosition, position) };
+
+				if (countEdges(position, nextPosition) > 1 || amountOfOppositeEdges > 1)
+				{
+					isPositionLocked[position] = true;
+					isPositionLocked[nextPosition] = true;
+				}
+				else if (amountOfOppositeEdges == 0)
+				{
+					isPositionOnBorder[position] = true;
+					isPositionOnBorder[nextPosition] = true;
+					++amountOfBorderEdges[position];
+					++amountOfBorderEdges[nextPosition];
+				}
+			}
+
+			for (size_t position{}; position < vertices.size(); ++position)
+			{
+				if (amountOfBorderEdges[position] > 2)
+					isPositionLocked[position] = true;
+			}
+
+			for (size_t index{}; index < indices.size(); index += 3)
+			{
+				const Vector3& v0{ vertices[indices[index]].position };
+				const Vector3 normal{ Vector3::Cross(vertices[indices[index + 1]].position - v0, vertices[indices[index + 2]].position - v0) };
+				const float length{ normal.Magnitude() };
+
+				if (length <= 0.f)
+					continue;
+
+				Quadric quadric{};
+				quadric.AddPlane(normal / length, -Vector3::Dot(normal / length, v0), length / 2.f);
+
+				for (size_t corner{}; corner < 3; ++corner)
+				{
+					quadrics[positionIndices[index + corner]].Add(quadric);
+				}
+
+				//a plane through every border edge that stands straight on the triangle keeps the outline of the border in place
+				for (size_t corner{}; corner < 3; ++corner)
+				{
+					const uint32_t position{ positionIndices[index + corner] };
+					const uint32_t nextPosition{ positionIndices[index + (corner + 1) % 3] };
+
+					if (countEdges(nextPosition, position) != 0)
+						continue;
+
+					const Vector3 edge{ vertices[nextPosition].position - vertices[position].position };
+					const Vector3 borderNormal{ Vector3::Cross(edge, normal) };
+					const float borderNormalLength{ borderNormal.Magnitude() };
+
+					if (borderNormalLength <= 0.f)
+						continue;
+
+					Quadric borderQuadric{};
+					borderQuadric.AddPlane(borderNormal / borderNormalLength, -Vector3::Dot(borderNormal / borderNormalLength, vertices[position].position), edge.SqrMagnitude());
+					quadrics[position].Add(borderQuadric);
+					quadrics[nextPosition].Add(borderQuadric);
+				}
+			}
+
+			//half edge collapses: the position "from" moves onto "to" and the triangles that had both disappear
+			struct Collapse
+			{
+				uint32_t from;
+				uint32_t to;
+				double cost;
+			};
+
+			std::vector<bool> isPositionTouched(vertices.size(), false);
+			std::vector<Collapse> collapses{};
+
+			struct WedgeTarget
+			{
+				uint32_t from;
+				uint32_t to;
+			};
+
+			std::vector<WedgeTarget> wedgeTargets{};
+			size_t amountOfIndices{ indices.size() };
+			double maximumCost{};
+
+			const auto findCorner = [&](size_t triangle, uint32_t position) -> int32_t
+			{
+				for (int32_t corner{}; corner < 3; ++corner)
+				{
+					if (positionRemap[simplifiedIndices[triangle * 3 + corner]] == position)
+						return corner;
+				}
+
+				return -1;
+			};
+
+			//a pass does the cheapest collapses that don't touch a position another collapse of the pass already moved
+			while (amountOfIndices > targetAmountOfIndices)
+			{
+				buildEdges();
+
+				const VertexTriangles positionTriangles{ BuildVertexTriangles(positionIndices, vertices.size()) };
+				collapses.clear();
+
+				for (size_t index{}; index < simplifiedIndices.size(); ++index)
+				{
+					if (isTriangleRemoved[index / 3])
+						continue;
+
+					const size_t nextIndex{ index % 3 == 2 ? index - 2 : index + 1 };
+					const uint32_t position{ positionIndices[index] };
+					const uint32_t nextPosition{ positionIndices[nextIndex] };
+
+					const bool isBorderEdge{ countEdges(nextPosition, position) == 0 };
+
+					Quadric edgeQuadric{ quadrics[position] };
+					edgeQuadric.Add(quadrics[nextPosition]);
+
+					if (!isPositionLocked[position] && (!isPositionOnBorder[position] || isBorderEdge))
+						collapses.push_back({ position, nextPosition, edgeQuadric.Evaluate(vertices[nextPosition].position) });
+
+					if (!isPositionLocked[nextPosition] && (!isPositionOnBorder[nextPosition] || isBorderEdge))
+						collapses.push_back({ nextPosition, position, edgeQuadric.Evaluate(vertices[position].position) });
+				}
+
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& collapse0, const Collapse& collapse1) { return collapse0.cost < collapse1.cost; });
+				std::fill(isPositionTouched.begin(), isPositionTouched.end(), false);
+
+				size_t amountOfCollapses{};
+				//a collapse that is skipped now can be done in the next pass, so a pass removes at most half of what is left to remove
+				const size_t passTargetAmountOfIndices{ std::max(targetAmountOfIndices, amountOfIndices - (amountOfIndices - targetAmountOfIndices) / 6 * 3) };
+
+				for (const Collapse& collapse : collapses)
+				{
+					if (amountOfIndices <= passTargetAmountOfIndices)
+						break;
+
+					if (isPositionTouched[collapse.from] || isPositionTouched[collapse.to])
+						continue;
+
+					const auto findWedgeTarget = [&](uint32_t vertex)
+					{
+						const auto it{ std::find_if(wedgeTargets.begin(), wedgeTargets.end(), [vertex](const WedgeTarget& wedgeTarget) { return wedgeTarget.from == vertex; }) };
+						return it == wedgeTargets.end() ? UINT32_MAX : it->to;
+					};
+
+					//on a uv or normal seam "from" has several vertices, every one becomes the vertex of "to" on the same side of the seam
+					//that is the one they share a triangle with, so the collapse has to go along the seam
+					wedgeTargets.clear();
+					bool isValid{ true };
+
+					for (uint32_t offset{ positionTriangles.offsets[collapse.from] }; offset < positionTriangles.offsets[collapse.from + 1]; ++offset)
+					{
+						const uint32_t triangle{ positionTriangles.triangles[offset] };
+						const int32_t toCorner{ findCorner(triangle, collapse.to) };
+
+						if (isTriangleRemoved[triangle] || toCorner < 0)
+							continue;
+
+						const uint32_t fromVertex{ simplifiedIndices[triangle * 3 + findCorner(triangle, collapse.from)] };
+						const uint32_t toVertex{ simplifiedIndices[triangle * 3 + toCorner] };
+
+						//a seam that only "to" is on would be pulled over one side of it
+						const uint32_t existingTarget{ findWedgeTarget(fromVertex) };
+
+						if (existingTarget == UINT32_MAX)
+							wedgeTargets.push_back({ fromVertex, toVertex });
+						else if (existingTarget != toVertex)
+							isValid = false;
+					}
+
+					//an edge of the previous pass can be gone already
+					isValid = isValid && !wedgeTargets.empty();
+
+					//no remaining triangle may lose its vertex or turn over
+					for (uint32_t offset{ positionTriangles.offsets[collapse.from] }; offset < positionTriangles.offsets[collapse.from + 1] && isValid; ++offset)
+					{
+						const uint32_t triangle{ positionTriangles.triangles[offset] };
+
+						if (isTriangleRemoved[triangle] || findCorner(triangle, collapse.to) >= 0)
+							continue;
+
+						const int32_t fromCorner{ findCorner(triangle, collapse.from) };
+
+						if (findWedgeTarget(simplifiedIndices[triangle * 3 + fromCorner]) == UINT32_MAX)
+						{
+							isValid = false;
+							break;
+						}
+
+						Vector3 cornerPositions[3]{};
+
+						for (uint32_t corner{}; corner < 3; ++corner)
+						{
+							cornerPositions[corner] = vertices[simplifiedIndices[triangle * 3 + corner]].position;
+						}
+
+						const Vector3 normalBefore{ Vector3::Cross(cornerPositions[1] - cornerPositions[0], cornerPositions[2] - cornerPositions[0]) };
+						cornerPositions[fromCorner] = vertices[collapse.to].position;
+						const Vector3 normalAfter{ Vector3::Cross(cornerPositions[1] - cornerPositions[0], cornerPositions[2] - cornerPositions[0]) };
+
+						isValid = Vector3::Dot(normalBefore, normalAfter) > 0.f;
+					}
+
+					if (!isValid)
+						continue;
+
+					for (uint32_t offset{ positionTriangles.offsets[collapse.from] }; offset < positionTriangles.offsets[collapse.from + 1]; ++offset)
+					{
+						const uint32_t triangle{ positionTriangles.triangles[offset] };
+
+						if (isTriangleRemoved[triangle])
+							continue;
+
+						if (findCorner(triangle, collapse.to) >= 0)
+						{
+							isTriangleRemoved[triangle] = true;
+							amountOfIndices -= 3;
+							continue;
+						}
+
+						uint32_t& vertex{ simplifiedIndices[triangle * 3 + findCorner(triangle, collapse.from)] };
+						vertex = findWedgeTarget(vertex);
+					}
+
+					quadrics[collapse.to].Add(quadrics[collapse.from]);
+					maximumCost = std::max(maximumCost, collapse.cost);
+					isPositionTouched[collapse.from] = true;
+					isPositionTouched[collapse.to] = true;
+					++amountOfCollapses;
+				}
+
+				if (amountOfCollapses == 0)
+					break;
+			}
+
+			std::vector<uint32_t> remainingIndices{};
+			remainingIndices.reserve(amountOfIndices);
+
+			for (size_t triangle{}; triangle < amountOfTriangles; ++triangle)
+			{
+				if (isTriangleRemoved[triangle])
+					continue;
+
+				remainingIndices.insert(remainingIndices.end(), simplifiedIndices.begin() + triangle * 3, simplifiedIndices.begin() + triangle * 3 + 3);
+			}
+
+			error = static_cast<float>(std::sqrt(maximumCost));
+			return remainingIndices;
+		}
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "pch.h"
+#include "Mesh.h"
+
+namespace dae
+{
+	//load time passes over the triangles and vertices of an indexed mesh that don't change what it looks like
+	namespace MeshOptimizer
+	{
+		//post-transform vertex cache size that is optimized for, about what the GPU and the software vertex stage reuse
+		constexpr uint32_t defaultCacheSize{ 16 };
+		//the size limits of a meshlet, the same as common mesh shader limits
+		constexpr uint32_t maxMeshletVertices{ 64 };
+		constexpr uint32_t maxMeshletTriangles{ 124 };
+		//how much a new vertex weighs against a triangle normal that differs from the meshlet normal, when growing a meshlet
+		constexpr float meshletConeWeight{ 2.f };
+		//triangles that face further away from the meshlet normal than this cosine start another meshlet
+		constexpr float meshletMinimumNormalDot{ 0.85f };
+
+		//the triangles that use every vertex, the ones of vertex v are at triangles[offsets[v]] up to triangles[offsets[v + 1]], in the order of the indices
+		struct VertexTriangles
+		{
+			std::vector<uint32_t> offsets;
+			std::vector<uint32_t> triangles;
+		};
+
+		VertexTriangles BuildVertexTriangles(const std::vector<uint32_t>& indices, size_t amountOfVertices);
+
+		//average cache miss ratio: transformed vertices per triangle with a FIFO cache of cacheSize vertices,
+		//between 0.5 (every vertex is transformed once on a large regular grid) and 3 (no vertex is ever reused)
+		float CalculateACMR(const std::vector<uint32_t>& indices, size_t amountOfVertices, uint32_t cacheSize = defaultCacheSize);
+
+		//reorders the triangles so vertices are reused while they are still in the cache (Tipsify, Sander et al. 2007)
+		//the corners of every triangle keep their order, so the winding doesn't change
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t amountOfVertices, uint32_t cacheSize = defaultCacheSize);
+
+		//puts the vertices in the order the indices first use them, so fetching them walks through memory
+		//vertices that no triangle uses are removed
+		void OptimizeVertexFetch(std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices);
+
+		//splits the triangles into meshlets of at most maxVertices unique vertices and maxTriangles triangles and puts them after each other in the index buffer
+		//a meshlet grows over neighbouring triangles that face the same way, so its normal cone stays narrow enough to cull it
+		//with keepTriangleOrder the meshlets are runs of the triangles in their current order instead
+		std::vector<Mesh::Meshlet> BuildMeshlets(const std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices, bool keepTriangleOrder,
+			uint32_t maxVertices = maxMeshletVertices, uint32_t maxTriangles = maxMeshletTriangles);
+
+		//collapses the edges that change the surface least until at most targetAmountOfIndices are left, by the quadric error of Garland and Heckbert
+		//positions on uv or normal seams only move along the seam and positions on borders only move along the border, so it can stop above the target
+		//the vertices are not changed, the indices only use fewer of them
+		//error is the square root of the largest quadric cost of a collapse: the root mean square distance, weighted by triangle area,
+		//of the kept position to the planes of the original triangles it replaces, in model space
+		std::vector<uint32_t> Simplify(const std::vector<Mesh::Vertex_In>& vertices, const std::vector<uint32_t>& indices, size_t targetAmountOfIndices, float& error);
+	}
+}
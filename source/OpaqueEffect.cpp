@@ -5,19 +5,26 @@
 
 namespace dae
 {
-	OpaqueEffect::OpaqueEffect(ID3D11Device* pDevice, const std::wstring& filePath)
+	OpaqueEffect::OpaqueEffect(ID3D11Device* pDevice, const std::wstring& filePath, Mesh::VertexFormat vertexFormat)
 		: Effect(pDevice, filePath)
 	{
-		m_pSamplerStateVariable = m_pEffect->GetVariableByName("gSamplerState")->AsSampler();
-		if (!m_pSamplerStateVariable->IsValid())
+		const bool isCompact{ vertexFormat == Mesh::VertexFormat::compact };
+
+		if (isCompact)
 		{
-			std::wcout << L"m_pSamplerStateVariable not valid!\n";
+			m_pTechnique->Release();
+
+			m_pTechnique = m_pEffect->GetTechniqueByName("CompactTechnique");
+			if (!m_pTechnique->IsValid())
+			{
+				std::wcout << L"CompactTechnique not valid\n";
+			}
 		}
 
-		m_pWorldMatrixVariable = m_pEffect->GetVariableByName("gWorld")->AsMatrix();
-		if (!m_pWorldMatrixVariable->IsValid())
+		m_pSamplerStateVariable = m_pEffect->GetVariableByName("gSamplerState")->AsSampler();
+		if (!m_pSamplerStateVariable->IsValid())
 		{
-			std::wcout << L"m_pWorldMatrixVariable not valid!\n";
+			std::wcout << L"m_pSamplerStateVariable not valid!\n";
 		}
 
 		m_pViewInverseMatrixVariable = m_pEffect->GetVariableByName("gViewInverse")->AsMatrix();
@@ -26,48 +33,52 @@ namespace dae
 			std::wcout << L"m_pMatWorldViewProjVariable not valid!\n";
 		}
 
-		m_pNormalMapVariable = m_pEffect->GetVariableByName("gNormalMap")->AsShaderResource();
-		if (!m_pNormalMapVariable->IsValid())
+		m_pMaterialMapVariable = m_pEffect->GetVariableByName("gMaterialMap")->AsShaderResource();
+		if (!m_pMaterialMapVariable->IsValid())
 		{
-			std::wcout << L"m_pNormalMapVariable not valid!\n";
+			std::wcout << L"m_pMaterialMapVariable not valid!\n";
 		}
 
-		m_pSpecularMapVariable = m_pEffect->GetVariableByName("gSpecularMap")->AsShaderResource();
-		if (!m_pSpecularMapVariable->IsValid())
+		m_pPositionOffsetVariable = m_pEffect->GetVariableByName("gPositionOffset")->AsVector();
+		if (!m_pPositionOffsetVariable->IsValid())
 		{
-			std::wcout << L"m_pSpecularMapVariable not valid!\n";
+			std::wcout << L"m_pPositionOffsetVariable not valid!\n";
 		}
 
-		m_pGlossinessMapVariable = m_pEffect->GetVariableByName("gGlossinessMap")->AsShaderResource();
-		if (!m_pGlossinessMapVariable->IsValid())
+		m_pPositionScaleVariable = m_pEffect->GetVariableByName("gPositionScale")->AsVector();
+		if (!m_pPositionScaleVariable->IsValid())
 		{
-			std::wcout << L"m_pGlossinessMapVariable not valid!\n";
+			std::wcout << L"m_pPositionScaleVariable not valid!\n";
 		}
 
 		//Create Vertex Layout
-		static constexpr uint32_t amountOfElements{ 4 };
+		static constexpr uint32_t amountOfVertexElements{ 4 };
+		static constexpr uint32_t amountOfElements{ amountOfVertexElements + amountOfInstanceElements };
 		D3D11_INPUT_ELEMENT_DESC vertexDesc[amountOfElements]{};
 
+		//offsets and formats of Mesh::Vertex_In or Mesh::CompactVertex_In
 		vertexDesc[0].SemanticName = "POSITION";
-		vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+		vertexDesc[0].Format = isCompact ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT;
 		vertexDesc[0].AlignedByteOffset = 0;
 		vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		vertexDesc[1].SemanticName = "TEXTCOORD";
-		vertexDesc[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-		vertexDesc[1].AlignedByteOffset = 12;
+		vertexDesc[1].Format = isCompact ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R32G32_FLOAT;
+		vertexDesc[1].AlignedByteOffset = isCompact ? 8 : 12;
 		vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		vertexDesc[2].SemanticName = "NORMAL";
-		vertexDesc[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[2].AlignedByteOffset = 20;
+		vertexDesc[2].Format = isCompact ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+		vertexDesc[2].AlignedByteOffset = isCompact ? 12 : 20;
 		vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
 		vertexDesc[3].SemanticName = "TANGENT";
-		vertexDesc[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		vertexDesc[3].AlignedByteOffset = 32;
+		vertexDesc[3].Format = isCompact ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32A32_FLOAT; //the full one has the sign in w
+		vertexDesc[3].AlignedByteOffset = isCompact ? 16 : 32;
 		vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
+		SetInstanceElements(vertexDesc + amountOfVertexElements);
+
 		//Create Input Layout
 		D3DX11_PASS_DESC passDesc{};
 		m_pTechnique->GetPassByIndex(0)->GetDesc(&passDesc);
@@ -93,20 +104,17 @@ namespace dae
 		if (m_pSamplerStateVariable)
 			m_pSamplerStateVariable->Release();
 
-		if (m_pWorldMatrixVariable)
-			m_pWorldMatrixVariable->Release();
-
 		if (m_pViewInverseMatrixVariable)
 			m_pViewInverseMatrixVariable->Release();
 
-		if (m_pNormalMapVariable)
-			m_pNormalMapVariable->Release();
+		if (m_pMaterialMapVariable)
+			m_pMaterialMapVariable->Release();
 
-		if (m_pSpecularMapVariable)
-			m_pSpecularMapVariable->Release();
+		if (m_pPositionOffsetVariable)
+			m_pPositionOffsetVariable->Release();
 
-		if (m_pGlossinessMapVariable)
-			m_pGlossinessMapVariable->Release();
+		if (m_pPositionScaleVariable)
+			m_pPositionScaleVariable->Release();
 	}
 
 	void OpaqueEffect::SetSamplerState(ID3D11SamplerState* pSamplerState)
@@ -115,33 +123,28 @@ namespace dae
 			m_pSamplerStateVariable->SetSampler(0, pSamplerState);
 	}
 
-	void OpaqueEffect::SetWorldMatrix(const dae::Matrix& worldMatrix)
-	{
-		if (m_pWorldMatrixVariable)
-			m_pWorldMatrixVariable->SetMatrix(reinterpret_cast<const float*>(&worldMatrix));
-	}
-
 	void OpaqueEffect::SetViewInverseMatrix(const dae::Matrix& invViewMatrix)
 	{
 		if (m_pViewInverseMatrixVariable)
 			m_pViewInverseMatrixVariable->SetMatrix(reinterpret_cast<const float*>(&invViewMatrix));
 	}
 
-	void OpaqueEffect::SetNormalMap(dae::Texture* pNormalTexture)
+	void OpaqueEffect::SetMaterialMap(dae::Texture* pMaterialTexture)
 	{
-		if (m_pNormalMapVariable)
-			m_pNormalMapVariable->SetResource(pNormalTexture->GetSRV());
+		if (m_pMaterialMapVariable)
+			m_pMaterialMapVariable->SetResource(pMaterialTexture->GetSRV());
 	}
 
-	void OpaqueEffect::SetSpecularMap(dae::Texture* pSpecularTexture)
+	void OpaqueEffect::SetPositionDequantization(const Vector3& boundsMin, const Vector3& boundsExtent)
 	{
-		if (m_pSpecularMapVariable)
-			m_pSpecularMapVariable->SetResource(pSpecularTexture->GetSRV());
-	}
+		//SetFloatVector always reads four floats
+		const float positionOffset[4]{ boundsMin.x, boundsMin.y, boundsMin.z, 0.f };
+		const float positionScale[4]{ boundsExtent.x, boundsExtent.y, boundsExtent.z, 0.f };
 
-	void OpaqueEffect::SetGlossinessMap(dae::Texture* pGlossinessTexture)
-	{
-		if (m_pGlossinessMapVariable)
-			m_pGlossinessMapVariable->SetResource(pGlossinessTexture->GetSRV());
+		if (m_pPositionOffsetVariable)
+			m_pPositionOffsetVariable->SetFloatVector(positionOffset);
+
+		if (m_pPositionScaleVariable)
+			m_pPositionScaleVariable->SetFloatVector(positionScale);
 	}
 }
\ No newline at end of file
@@ -1,12 +1,14 @@
 #include "pch.h"
 #include "Effect.h"
+#include "Mesh.h"
 
 namespace dae
 {
 	class OpaqueEffect final : public Effect
 	{
 	public:
-		OpaqueEffect(ID3D11Device* pDevice, const std::wstring& filePath);
+		//the compact vertex format uses its own technique, with a vertex shader that decodes the vertices
+		OpaqueEffect(ID3D11Device* pDevice, const std::wstring& filePath, Mesh::VertexFormat vertexFormat);
 		~OpaqueEffect();
 
 		OpaqueEffect(const OpaqueEffect& other) = delete;
@@ -15,18 +17,16 @@ namespace dae
 		OpaqueEffect& operator=(OpaqueEffect&& other) = delete;
 
 		void SetSamplerState(ID3D11SamplerState* pSamplerState);
-		void SetWorldMatrix(const dae::Matrix& worldMatrix);
 		void SetViewInverseMatrix(const dae::Matrix& invViewMatrix);
-		void SetNormalMap(dae::Texture* pNormalTexture);
-		void SetSpecularMap(dae::Texture* pSpecularTexture);
-		void SetGlossinessMap(dae::Texture* pGlossinessTexture);
+		void SetMaterialMap(dae::Texture* pMaterialTexture);
+		//compact positions go from 0 to 1 within the bounds of the mesh
+		void SetPositionDequantization(const Vector3& boundsMin, const Vector3& boundsExtent);
 
 	private:
 		ID3DX11EffectSamplerVariable* m_pSamplerStateVariable;
-		ID3DX11EffectMatrixVariable* m_pWorldMatrixVariable;
 		ID3DX11EffectMatrixVariable* m_pViewInverseMatrixVariable;
-		ID3DX11EffectShaderResourceVariable* m_pNormalMapVariable;
-		ID3DX11EffectShaderResourceVariable* m_pSpecularMapVariable;
-		ID3DX11EffectShaderResourceVariable* m_pGlossinessMapVariable;
+		ID3DX11EffectShaderResourceVariable* m_pMaterialMapVariable;
+		ID3DX11EffectVectorVariable* m_pPositionOffsetVariable;
+		ID3DX11EffectVectorVariable* m_pPositionScaleVariable;
 	};
 }
\ No newline at end of file
@@ -3,18 +3,18 @@
 #include "OpaqueEffect.h"
 #include "Texture.h"
 #include <cassert>
-#include <ppl.h> //parallel_for
-
-#define PARALLEL_FOR
 
 namespace dae
 {
-	OpaqueMesh::OpaqueMesh(ID3D11Device* pDevice, const std::string& modelFilePath, const std::wstring& shaderFilePath, CullMode cullMode, Sampler* pSampler, float windowWidth, float windowHeight)
-		: Mesh(pDevice, modelFilePath, windowWidth, windowHeight)
-		, m_pEffect{ new OpaqueEffect(pDevice, shaderFilePath) }
+	OpaqueMesh::OpaqueMesh(ID3D11Device* pDevice, const std::string& modelFilePath, const std::wstring& shaderFilePath, CullMode cullMode, Sampler* pSampler, float windowWidth, float windowHeight, VertexFormat vertexFormat)
+		: Mesh(pDevice, modelFilePath, windowWidth, windowHeight, vertexFormat)
+		, m_pEffect{ new OpaqueEffect(pDevice, shaderFilePath, vertexFormat) }
 		, m_CullMode{ cullMode }
 	{
 		ChangeSamplerState(pSampler);
+
+		if (vertexFormat == VertexFormat::compact)
+			m_pEffect->SetPositionDequantization(m_BoundsMin, m_BoundsExtent);
 	}
 
 	OpaqueMesh::~OpaqueMesh()
@@ -27,8 +27,6 @@ namespace dae
 
 	void OpaqueMesh::RenderHardware(ID3D11DeviceContext* pDeviceContext) const
 	{
-		m_pEffect->SetWorldMatrix(m_WorldMatrix);
-		
 		//1. Set Primitive Topology and the rasterizerState
 		pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		pDeviceContext->RSSetState(m_pRasterizerState);
@@ -37,81 +35,58 @@ namespace dae
 		pDeviceContext->IASetInputLayout(m_pEffect->GetInputLayout());
 
 		//3. Set VertexBuffer
-		constexpr UINT stride{ sizeof(Vertex_In) };
+		const UINT stride{ GetVertexSize() };
 		constexpr UINT offset{ 0 };
 		pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
+		SetInstanceBuffer(pDeviceContext);
 
 		//4. Set IndexBuffer
 		pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
 		//5. Draw
+		const LevelOfDetail& levelOfDetail{ m_LevelsOfDetail[m_LevelOfDetail] };
 		D3DX11_TECHNIQUE_DESC techniqueDesc{};
 		m_pEffect->GetTechnique()->GetDesc(&techniqueDesc);
 
 		for (UINT index{}; index < techniqueDesc.Passes; ++index)
 		{
 			m_pEffect->GetTechnique()->GetPassByIndex(index)->Apply(0, pDeviceContext);
-			pDeviceContext->DrawIndexed(m_AmountOfIndices, 0, 0);
+			pDeviceContext->DrawIndexedInstanced(levelOfDetail.amountOfIndices, GetAmountOfInstances(), levelOfDetail.firstIndex, 0, 0);
 		}
 	}
 
-	void OpaqueMesh::RenderSoftware(const Camera& camera, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels)
+	void OpaqueMesh::BinTriangles(SoftwareFrame& frame)
 	{
-		VertexTransformationFunction(camera);
+		//submission order stays the index order within every instance, the visible meshlets are in that order
+		for (const VisibleMeshlet& visibleMeshlet : frame.visibleMeshlets)
+		{
+			const Meshlet& meshlet{ m_Meshlets[visibleMeshlet.meshlet] };
+			const uint32_t endIndex{ (meshlet.firstTriangle + meshlet.amountOfTriangles) * 3 };
 
-#ifdef PARALLEL_FOR
-		concurrency::parallel_for(0u, m_AmountOfIndices, 3u, [=, this](uint32_t index)
+			for (uint32_t index{ meshlet.firstTriangle * 3 }; index < endIndex; index += 3)
 			{
 				if (m_Indices[index] == m_Indices[index + 1]
 					|| m_Indices[index + 1] == m_Indices[index + 2]
 					|| m_Indices[index + 2] == m_Indices[index])
-					return;
-
-				Vertex_Out& vertex0{ m_VerticesOut[m_Indices[index]] };
-				Vertex_Out& vertex1{ m_VerticesOut[m_Indices[index + 1]] };
-				Vertex_Out& vertex2{ m_VerticesOut[m_Indices[index + 2]] };
-
+					continue;
+		
+				const Vertex_Out& vertex0{ GetVertexOut(frame, visibleMeshlet.instance, index) };
+				const Vertex_Out& vertex1{ GetVertexOut(frame, visibleMeshlet.instance, index + 1) };
+				const Vertex_Out& vertex2{ GetVertexOut(frame, visibleMeshlet.instance, index + 2) };
+		
 				if (!IsTriangleInFrustum(vertex0, vertex1, vertex2))
-					return;
-
-				TransformVerticesToScreenSpace(vertex0, vertex1, vertex2);
-
+					continue;
+		
 				const Vector2 v0{ vertex0.position.x, vertex0.position.y };
 				const Vector2 v1{ vertex1.position.x, vertex1.position.y };
 				const Vector2 v2{ vertex2.position.x, vertex2.position.y };
-
-				const float area{ Vector2::Cross(v1 - v0, v2 - v0) / 2.f };
-
-				if (ShouldRenderTriangle(m_CullMode, area))
-					RenderTriangle(index / 3, vertex0, vertex1, vertex2, area, pDepthBufferPixels, pBackBuffer, pBackBufferPixels);
-			});
-#else
-		for (int index{}; index < static_cast<int>(m_AmountOfIndices); index += 3)
-		{
-			if (m_Indices[index] == m_Indices[index + 1]
-				|| m_Indices[index + 1] == m_Indices[index + 2]
-				|| m_Indices[index + 2] == m_Indices[index])
-				continue;
-		
-			Vertex_Out& vertex0{ m_VerticesOut[m_Indices[index]] };
-			Vertex_Out& vertex1{ m_VerticesOut[m_Indices[index + 1]] };
-			Vertex_Out& vertex2{ m_VerticesOut[m_Indices[index + 2]] };
-		
-			if (!IsTriangleInFrustum(vertex0, vertex1, vertex2))
-				continue;
 		
-			TransformVerticesToScreenSpace(vertex0, vertex1, vertex2);
-		
-			const Vector2 v0{ vertex0.position.x, vertex0.position.y };
-			const Vector2 v1{ vertex1.position.x, vertex1.position.y };
-			const Vector2 v2{ vertex2.position.x, vertex2.position.y };
-		
-			const float area{ Vector2::Cross(v1 - v0, v2 - v0) / 2.f };
+				const float area{ Vector2::Cross(v1 - v0, v2 - v0) / 2.f };
 		
-			if (ShouldRenderTriangle(m_CullMode, area))
-				RenderTriangle(index / 3, vertex0, vertex1, vertex2, area, pDepthBufferPixels, pBackBuffer, pBackBufferPixels);
+				if (ShouldRenderTriangle(m_CullMode, area))
+					BinTriangle(frame, visibleMeshlet.instance, index / 3, area);
+			}
 		}
-#endif
 	}
 
 	bool OpaqueMesh::ShouldRenderTriangle(CullMode cullMode, float area) const
@@ -132,11 +107,35 @@ namespace dae
 
 		return false;
 	}
+
+	bool OpaqueMesh::IsMeshletCulledByFacing(const Meshlet& meshlet, const Vector3& modelSpaceCameraPosition) const
+	{
+		switch (m_CullMode)
+		{
+		case CullMode::BackFace:
+			return IsMeshletFacingAway(meshlet, modelSpaceCameraPosition, false);
+
+		case CullMode::FrontFace:
+			return IsMeshletFacingAway(meshlet, modelSpaceCameraPosition, true);
+
+		case CullMode::None:
+			return false;
+		}
+
+		return false;
+	}
 	
 	void OpaqueMesh::ChangeSamplerState(Sampler* pSampler)
 	{
 		m_SamplerState = pSampler->GetSamplerStateKind();
+		m_AddressMode = pSampler->GetAddressMode();
 		m_pEffect->SetSamplerState(pSampler->GetSamplerState());
+
+		if (m_pDiffuseMap)
+			m_pDiffuseMap->SetAddressMode(m_AddressMode);
+
+		if (m_pMaterialMap)
+			m_pMaterialMap->SetAddressMode(m_AddressMode);
 	}
 
 	void OpaqueMesh::SetRasterizerState(ID3D11RasterizerState* pRasterizerState)
@@ -154,29 +153,19 @@ namespace dae
 	{
 		m_pEffect->SetDiffuseMap(diffuseMap);
 		m_pDiffuseMap = diffuseMap;
+		m_pDiffuseMap->SetAddressMode(m_AddressMode);
 	}
 
-	void OpaqueMesh::SetNormalMap(Texture* normalMap)
-	{
-		m_pEffect->SetNormalMap(normalMap);
-		m_pNormalMap = normalMap;
-	}
-
-	void OpaqueMesh::SetSpecularMap(Texture* specularMap)
-	{
-		m_pEffect->SetSpecularMap(specularMap);
-		m_pSpecularMap = specularMap;
-	}
-
-	void OpaqueMesh::SetGlossinessMap(Texture* glossinessMap)
+	void OpaqueMesh::SetMaterialMap(Texture* materialMap)
 	{
-		m_pEffect->SetGlossinessMap(glossinessMap);
-		m_pGlossinessMap = glossinessMap;
+		m_pEffect->SetMaterialMap(materialMap);
+		m_pMaterialMap = materialMap;
+		m_pMaterialMap->SetAddressMode(m_AddressMode);
 	}
 
-	void OpaqueMesh::SetWorldViewProjMatrix(const Matrix& worldViewProjMatrix)
+	void OpaqueMesh::SetViewProjMatrix(const Matrix& viewProjMatrix)
 	{
-		m_pEffect->SetWorldViewProjMatrix(worldViewProjMatrix);
+		m_pEffect->SetViewProjMatrix(viewProjMatrix);
 	}
 
 	void OpaqueMesh::SetViewInverseMatrix(const Matrix& viewInverseMatrix)
@@ -184,7 +173,7 @@ namespace dae
 		m_pEffect->SetViewInverseMatrix(viewInverseMatrix);
 	}
 
-	ColorRGBA OpaqueMesh::ShadePixel(const Vertex_Out& vertex) const
+	ColorRGBA OpaqueMesh::ShadePixel(const Vertex_Out& vertex, const UVDerivatives& uvDerivatives) const
 	{
 		if (m_VisualizeDepthBuffer)
 		{
@@ -198,22 +187,23 @@ namespace dae
 		constexpr float shininess{ 25.f };
 		Vector3 normal{ vertex.normal };
 
+		//normal x and y, specular and glossiness in one sample
+		const ColorRGBA material{ m_pMaterialMap->Sample(vertex.uv, uvDerivatives.ddx, uvDerivatives.ddy, m_SamplerState) };
+		const ColorRGBA specularColor{ material.b, material.b, material.b };
+		const float glossiness{ material.a };
+
 		if (m_UseNormalMap)
 		{
-			ColorRGBA sampledNormal{ m_pNormalMap->Sample(vertex.uv) };
-
 			//remap the normal values to range [-1, 1]
-			sampledNormal.r = 2.f * sampledNormal.r - 1.f;
-			sampledNormal.g = 2.f * sampledNormal.g - 1.f;
-			sampledNormal.b = 2.f * sampledNormal.b - 1.f;
-			sampledNormal.a = 2.f * sampledNormal.a - 1.f;
+			Vector3 sampledNormal{ 2.f * material.r - 1.f, 2.f * material.g - 1.f, 0.f };
 
-			Vector3 binormal{ Vector3::Cross(vertex.normal, vertex.tangent) };
-			Matrix tangentSpaceAxis{ vertex.tangent, binormal, vertex.normal, Vector3::Zero };
+			//only x and y are stored, z follows from the normal having length 1
+			sampledNormal.z = sqrtf(std::max(0.f, 1.f - sampledNormal.x * sampledNormal.x - sampledNormal.y * sampledNormal.y));
+
+			Matrix tangentSpaceAxis{ vertex.tangent, vertex.binormal, vertex.normal, Vector3::Zero };
 
 			//transform the sampledNormal to tangent space
-			normal = { sampledNormal.r, sampledNormal.g, sampledNormal.b };
-			normal = tangentSpaceAxis.TransformVector(normal).Normalized();
+			normal = tangentSpaceAxis.TransformVector(sampledNormal).Normalized();
 		}
 
 		observedArea = std::max(0.f, Vector3::Dot(normal, -lightDirection));
@@ -227,10 +217,10 @@ namespace dae
 				//lambert diffuse
 				ColorRGBA diffuse{};
 				
-				diffuse = lightIntensity * m_pDiffuseMap->Sample(vertex.uv) / PI;
+				diffuse = lightIntensity * m_pDiffuseMap->Sample(vertex.uv, uvDerivatives.ddx, uvDerivatives.ddy, m_SamplerState) / PI;
 
 				//specular phong
-				ColorRGBA specular{m_pSpecularMap->Sample(vertex.uv) * powf(std::max(Vector3::Dot(Vector3::Reflect(lightDirection, normal), vertex.viewDirection), 0.f),  m_pGlossinessMap->Sample(vertex.uv).r * shininess )}; //glossinessMap is greyscale so all channels have the same value
+				ColorRGBA specular{ specularColor * powf(std::max(Vector3::Dot(Vector3::Reflect(lightDirection, normal), vertex.viewDirection), 0.f), glossiness * shininess) };
 
 				return (diffuse + specular + ambient) * observedArea;
 			}
@@ -240,13 +230,13 @@ namespace dae
 
 			case ShadingMode::diffuse:
 			{
-				ColorRGBA diffuse{ lightIntensity * m_pDiffuseMap->Sample(vertex.uv) / PI };
+				ColorRGBA diffuse{ lightIntensity * m_pDiffuseMap->Sample(vertex.uv, uvDerivatives.ddx, uvDerivatives.ddy, m_SamplerState) / PI };
 				return diffuse * observedArea;
 			}
 
 			case ShadingMode::specular:
 			{
-				ColorRGBA specular{ m_pSpecularMap->Sample(vertex.uv) * powf(std::max(Vector3::Dot(2.f * std::max(Vector3::Dot(normal, -lightDirection), 0.f) * normal - -lightDirection, vertex.viewDirection), 0.f), shininess * m_pGlossinessMap->Sample(vertex.uv).r) }; //glossinessMap is greyscale so all channels have the same value
+				ColorRGBA specular{ specularColor * powf(std::max(Vector3::Dot(2.f * std::max(Vector3::Dot(normal, -lightDirection), 0.f) * normal - -lightDirection, vertex.viewDirection), 0.f), shininess * glossiness) };
 				return specular * observedArea;
 			}
 		}
@@ -254,7 +244,7 @@ namespace dae
 		return ColorRGBA{ 0.f, 0.f, 0.f };
 	}
 
-	void OpaqueMesh::RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const
+	void OpaqueMesh::RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels, const Vector2& tileMin, const Vector2& tileMax) const
 	{
 		const Vector2 v0{ vertex0.position.x, vertex0.position.y };
 		const Vector2 v1{ vertex1.position.x, vertex1.position.y };
@@ -265,6 +255,12 @@ namespace dae
 
 		CalculateBoundingBox(v0, v1, v2, min, max);
 
+		//only touch the pixels of the tile that is being rendered
+		min.x = std::max(min.x, tileMin.x);
+		min.y = std::max(min.y, tileMin.y);
+		max.x = std::min(max.x, tileMax.x);
+		max.y = std::min(max.y, tileMax.y);
+
 		if (m_VisualzeBoundingBox)
 		{
 			VisualizeBoundingBox(min, max, pBackBuffer, pBackBufferPixels);
@@ -307,7 +303,9 @@ namespace dae
 		}
 		else return;
 
-		ColorRGBA finalColor{ ShadePixel(CalculatePixel(pixelPos, w0, w1, w2, triangleVertex0, triangleVertex1, triangleVertex2, depthInterpolated)) };
+		const UVDerivatives uvDerivatives{ CalculateUVDerivatives(pixelPos, triangleVertex0, triangleVertex1, triangleVertex2, triangleArea) };
+
+		ColorRGBA finalColor{ ShadePixel(CalculatePixel(pixelPos, w0, w1, w2, triangleVertex0, triangleVertex1, triangleVertex2, depthInterpolated), uvDerivatives) };
 
 		//Update Color in Buffer
 		finalColor.MaxToOne();
@@ -17,7 +17,7 @@ namespace dae
 			None
 		};
 
-		OpaqueMesh(ID3D11Device* pDevice, const std::string& modelFilePath, const std::wstring& shaderFilePath, CullMode cullMode, Sampler* pSampler, float windowWidth, float windowHeight);
+		OpaqueMesh(ID3D11Device* pDevice, const std::string& modelFilePath, const std::wstring& shaderFilePath, CullMode cullMode, Sampler* pSampler, float windowWidth, float windowHeight, VertexFormat vertexFormat = VertexFormat::full);
 		~OpaqueMesh();
 
 		OpaqueMesh(const OpaqueMesh& other) = delete;
@@ -34,12 +34,10 @@ namespace dae
 		};
 
 		virtual void RenderHardware(ID3D11DeviceContext* pDeviceContext) const override;
-		virtual void RenderSoftware(const Camera& camera, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) override;
 		void SetDiffuseMap(Texture* diffuseMap);
-		void SetNormalMap(Texture* normalMap);
-		void SetSpecularMap(Texture* specularMap);
-		void SetGlossinessMap(Texture* glossinessMap);
-		void SetWorldViewProjMatrix(const Matrix& worldViewProjMatrix);
+		//normal x and y in red and green, specular in blue and glossiness in alpha
+		void SetMaterialMap(Texture* materialMap);
+		void SetViewProjMatrix(const Matrix& viewProjMatrix);
 		void SetViewInverseMatrix(const Matrix& viewInverseMatrix);
 		void ChangeSamplerState(Sampler* pSampler);
 		Sampler::SamplerStateKind GetSamplerStateKind() const { return m_SamplerState; }
@@ -53,12 +51,11 @@ namespace dae
 		OpaqueEffect* m_pEffect;
 
 		Sampler::SamplerStateKind m_SamplerState;
+		Sampler::AddressMode m_AddressMode{ Sampler::AddressMode::wrap };
 		ID3D11RasterizerState* m_pRasterizerState{ nullptr };
 		
 		Texture* m_pDiffuseMap{ nullptr };
-		Texture* m_pNormalMap{ nullptr };
-		Texture* m_pSpecularMap{ nullptr };
-		Texture* m_pGlossinessMap{ nullptr };
+		Texture* m_pMaterialMap{ nullptr };
 
 		bool m_UseNormalMap{ true };
 		bool m_VisualizeDepthBuffer{};
@@ -70,8 +67,10 @@ namespace dae
 		int amount{};
 
 		bool ShouldRenderTriangle(CullMode cullMode, float area) const;
-		virtual void RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const override;
+		virtual bool IsMeshletCulledByFacing(const Meshlet& meshlet, const Vector3& modelSpaceCameraPosition) const override;
+		virtual void BinTriangles(SoftwareFrame& frame) override;
+		virtual void RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels, const Vector2& tileMin, const Vector2& tileMax) const override;
 		virtual void RenderPixel(uint32_t pixelIndex, const Vertex_Out& triangleVertex0, const Vertex_Out& triangleVertex1, const Vertex_Out& triangleVertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const override;
-		virtual ColorRGBA ShadePixel(const Vertex_Out& vertex) const override;
+		virtual ColorRGBA ShadePixel(const Vertex_Out& vertex, const UVDerivatives& uvDerivatives) const override;
 	};
 }
\ No newline at end of file
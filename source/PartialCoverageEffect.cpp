@@ -9,7 +9,8 @@ namespace dae
 		: Effect(pDevice, filePath)
 	{
 		//Create Vertex Layout
-		static constexpr uint32_t amountOfElements{ 2 };
+		static constexpr uint32_t amountOfVertexElements{ 2 };
+		static constexpr uint32_t amountOfElements{ amountOfVertexElements + amountOfInstanceElements };
 		D3D11_INPUT_ELEMENT_DESC vertexDesc[amountOfElements]{};
 
 		vertexDesc[0].SemanticName = "POSITION";
@@ -22,6 +23,8 @@ namespace dae
 		vertexDesc[1].AlignedByteOffset = 12;
 		vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
+		SetInstanceElements(vertexDesc + amountOfVertexElements);
+
 		//Create Input Layout
 		D3DX11_PASS_DESC passDesc{};
 		m_pTechnique->GetPassByIndex(0)->GetDesc(&passDesc);
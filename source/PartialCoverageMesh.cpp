@@ -2,12 +2,11 @@
 #include "PartialCoverageMesh.h"
 #include "PartialCoverageEffect.h"
 #include "Texture.h"
-#include <ppl.h> //parallel_for
 
 namespace dae
 {
 	PartialCoverageMesh::PartialCoverageMesh(ID3D11Device* pDevice, const std::string& modelFilePath, const std::wstring& shaderFilePath, float windowWidth, float windowHeight)
-		: Mesh(pDevice, modelFilePath, windowWidth, windowHeight)
+		: Mesh(pDevice, modelFilePath, windowWidth, windowHeight, VertexFormat::full, true) //the triangles are blended in the order of the file
 		, m_pEffect{ new PartialCoverageEffect(pDevice, shaderFilePath) }
 	{}
 
@@ -28,53 +27,57 @@ namespace dae
 		constexpr UINT stride{ sizeof(Vertex_In) };
 		constexpr UINT offset{ 0 };
 		pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
+		SetInstanceBuffer(pDeviceContext);
 
 		//4. Set IndexBuffer
 		pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
 
 		//5. Draw
+		const LevelOfDetail& levelOfDetail{ m_LevelsOfDetail[m_LevelOfDetail] };
 		D3DX11_TECHNIQUE_DESC techniqueDesc{};
 		m_pEffect->GetTechnique()->GetDesc(&techniqueDesc);
 
 		for (UINT index{}; index < techniqueDesc.Passes; ++index)
 		{
 			m_pEffect->GetTechnique()->GetPassByIndex(index)->Apply(0, pDeviceContext);
-			pDeviceContext->DrawIndexed(m_AmountOfIndices, 0, 0);
+			pDeviceContext->DrawIndexedInstanced(levelOfDetail.amountOfIndices, GetAmountOfInstances(), levelOfDetail.firstIndex, 0, 0);
 		}
 	}
 
-	void  PartialCoverageMesh::RenderSoftware(const Camera& camera, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels)
+	void PartialCoverageMesh::BinTriangles(SoftwareFrame& frame)
 	{
-		VertexTransformationFunction(camera);
-
-		for (int index{}; index < static_cast<int>(m_AmountOfIndices); index += 3)
+		for (const VisibleMeshlet& visibleMeshlet : frame.visibleMeshlets)
 		{
-			if (m_Indices[index] == m_Indices[index + 1]
-				|| m_Indices[index + 1] == m_Indices[index + 2]
-				|| m_Indices[index + 2] == m_Indices[index]		)
-				continue;
+			const Meshlet& meshlet{ m_Meshlets[visibleMeshlet.meshlet] };
+			const uint32_t endIndex{ (meshlet.firstTriangle + meshlet.amountOfTriangles) * 3 };
 
-			Vertex_Out& vertex0{ m_VerticesOut[m_Indices[index]] };
-			Vertex_Out& vertex1{ m_VerticesOut[m_Indices[index + 1]] };
-			Vertex_Out& vertex2{ m_VerticesOut[m_Indices[index + 2]] };
+			for (uint32_t index{ meshlet.firstTriangle * 3 }; index < endIndex; index += 3)
+			{
+				if (m_Indices[index] == m_Indices[index + 1]
+					|| m_Indices[index + 1] == m_Indices[index + 2]
+					|| m_Indices[index + 2] == m_Indices[index]		)
+					continue;
 
-			//frustum clipping is turned off because it doesn't work as intended for this mesh
-			//if (IsTriangleInFrustum(vertex0, vertex1, vertex2))
-			//	continue;
+				const Vertex_Out& vertex0{ GetVertexOut(frame, visibleMeshlet.instance, index) };
+				const Vertex_Out& vertex1{ GetVertexOut(frame, visibleMeshlet.instance, index + 1) };
+				const Vertex_Out& vertex2{ GetVertexOut(frame, visibleMeshlet.instance, index + 2) };
 
-			TransformVerticesToScreenSpace(vertex0, vertex1, vertex2);
+				//frustum clipping is turned off because it doesn't work as intended for this mesh
+				//if (IsTriangleInFrustum(vertex0, vertex1, vertex2))
+				//	continue;
 
-			const Vector2 v0{ vertex0.position.x, vertex0.position.y };
-			const Vector2 v1{ vertex1.position.x, vertex1.position.y };
-			const Vector2 v2{ vertex2.position.x, vertex2.position.y };
+				const Vector2 v0{ vertex0.position.x, vertex0.position.y };
+				const Vector2 v1{ vertex1.position.x, vertex1.position.y };
+				const Vector2 v2{ vertex2.position.x, vertex2.position.y };
 
-			const float area{ Vector2::Cross(v1 - v0, v2 - v0) / 2.f };
+				const float area{ Vector2::Cross(v1 - v0, v2 - v0) / 2.f };
 
-			RenderTriangle(index / 3, vertex0, vertex1, vertex2, area, pDepthBufferPixels, pBackBuffer, pBackBufferPixels);
+				BinTriangle(frame, visibleMeshlet.instance, index / 3, area);
+			}
 		}
 	}
 
-	void PartialCoverageMesh::RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const
+	void PartialCoverageMesh::RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels, const Vector2& tileMin, const Vector2& tileMax) const
 	{
 		const Vector2 v0{ vertex0.position.x, vertex0.position.y };
 		const Vector2 v1{ vertex1.position.x, vertex1.position.y };
@@ -85,6 +88,12 @@ namespace dae
 
 		CalculateBoundingBox(v0, v1, v2, min, max);
 
+		//only touch the pixels of the tile that is being rendered
+		min.x = std::max(min.x, tileMin.x);
+		min.y = std::max(min.y, tileMin.y);
+		max.x = std::min(max.x, tileMax.x);
+		max.y = std::min(max.y, tileMax.y);
+
 		if (m_VisualzeBoundingBox)
 		{
 			VisualizeBoundingBox(min, max, pBackBuffer, pBackBufferPixels);
@@ -126,7 +135,9 @@ namespace dae
 
 		Vertex_Out pixel{ CalculatePixel(pixelPos, w0, w1, w2, triangleVertex0, triangleVertex1, triangleVertex2, depthInterpolated) };
 
-		ColorRGBA finalColor{ ShadePixel(pixel) };
+		const UVDerivatives uvDerivatives{ CalculateUVDerivatives(pixelPos, triangleVertex0, triangleVertex1, triangleVertex2, triangleArea) };
+
+		ColorRGBA finalColor{ ShadePixel(pixel, uvDerivatives) };
 
 		Uint8 rValue{}, gValue{}, bValue{};
 		SDL_GetRGB(pBackBufferPixels[pixelIndex], pBackBuffer->format, &rValue, &gValue, &bValue);
@@ -146,20 +157,23 @@ namespace dae
 		MapPixelToBackBuffer(pixelIndex, finalColor, pBackBuffer, pBackBufferPixels);
 	}
 
-	ColorRGBA PartialCoverageMesh::ShadePixel(const Vertex_Out& vertex) const
+	ColorRGBA PartialCoverageMesh::ShadePixel(const Vertex_Out& vertex, const UVDerivatives& uvDerivatives) const
 	{
 		constexpr float lightIntensity{ 7.f };
-		return lightIntensity * m_pDiffuseMap->Sample(vertex.uv) / PI;
+		//fireFX.fx samples with a point filter as well
+		return lightIntensity * m_pDiffuseMap->Sample(vertex.uv, uvDerivatives.ddx, uvDerivatives.ddy, Sampler::SamplerStateKind::point) / PI;
 	}
 
 	void PartialCoverageMesh::SetDiffuseMap(Texture* diffuseMap)
 	{
 		m_pEffect->SetDiffuseMap(diffuseMap);
 		m_pDiffuseMap = diffuseMap;
+		//fireFX.fx samples with wrap
+		m_pDiffuseMap->SetAddressMode(Sampler::AddressMode::wrap);
 	}
 
-	void PartialCoverageMesh::SetWorldViewProjMatrix(const Matrix& worldViewProjMatrix)
+	void PartialCoverageMesh::SetViewProjMatrix(const Matrix& viewProjMatrix)
 	{
-		m_pEffect->SetWorldViewProjMatrix(worldViewProjMatrix);
+		m_pEffect->SetViewProjMatrix(viewProjMatrix);
 	}
 }
\ No newline at end of file
@@ -18,16 +18,16 @@ namespace dae
 		PartialCoverageMesh& operator=(PartialCoverageMesh&& other) = delete;
 
 		virtual void RenderHardware(ID3D11DeviceContext* pDeviceContext) const override;
-		virtual void RenderSoftware(const Camera& camera, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) override;
 		void SetDiffuseMap(Texture* diffuseMap);
-		void SetWorldViewProjMatrix(const Matrix& worldViewProjMatrix);
+		void SetViewProjMatrix(const Matrix& viewProjMatrix);
 
 	private:
 		PartialCoverageEffect* m_pEffect;
 		Texture* m_pDiffuseMap{ nullptr };
 
-		virtual ColorRGBA ShadePixel(const Vertex_Out& vertex) const override;
-		virtual void RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const override;
+		virtual ColorRGBA ShadePixel(const Vertex_Out& vertex, const UVDerivatives& uvDerivatives) const override;
+		virtual void BinTriangles(SoftwareFrame& frame) override;
+		virtual void RenderTriangle(uint32_t triangleIndex, const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels, const Vector2& tileMin, const Vector2& tileMax) const override;
 		virtual void RenderPixel(uint32_t pixelIndex, const Vertex_Out& triangleVertex0, const Vertex_Out& triangleVertex1, const Vertex_Out& triangleVertex2, float triangleArea, float* pDepthBufferPixels, SDL_Surface* pBackBuffer, uint32_t* pBackBufferPixels) const override;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "pch.h"
+#include "RenderThread.h"
+#include "Renderer.h"
+
+namespace dae
+{
+	RenderThread::RenderThread(Renderer* pRenderer, const KeyHandler& keyHandler)
+		: m_pRenderer{ pRenderer }
+		, m_KeyHandler{ keyHandler }
+		, m_Thread{ &RenderThread::Run, this }
+	{
+	}
+
+	RenderThread::~RenderThread()
+	{
+		m_IsRunning = false;
+		m_Thread.join();
+	}
+
+	void RenderThread::QueueKey(SDL_Scancode scancode)
+	{
+		const uint32_t tail{ m_KeyQueueTail.load(std::memory_order_relaxed) };
+
+		//drop the key if the render thread is that far behind
+		if (tail - m_KeyQueueHead.load(std::memory_order_acquire) == m_KeyQueueSize)
+			return;
+
+		m_KeyQueue[tail % m_KeyQueueSize] = scancode;
+		m_KeyQueueTail.store(tail + 1, std::memory_order_release);
+	}
+
+	void RenderThread::Run()
+	{
+		Timer timer{};
+		timer.Start();
+		float printTimer{};
+
+		while (m_IsRunning)
+		{
+			const uint32_t tail{ m_KeyQueueTail.load(std::memory_order_acquire) };
+
+			for (uint32_t head{ m_KeyQueueHead.load(std::memory_order_relaxed) }; head != tail; ++head)
+			{
+				m_KeyHandler(m_KeyQueue[head % m_KeyQueueSize], &timer);
+				m_KeyQueueHead.store(head + 1, std::memory_order_release);
+			}
+
+			m_pRenderer->Render();
+
+			timer.Update();
+			printTimer += timer.GetElapsed();
+			if (printTimer >= 1.f && timer.GetPrintFPS())
+			{
+				printTimer = 0.f;
+				std::cout << "Render dFPS: " << timer.GetdFPS() << std::endl;
+				m_pRenderer->PrintThreadUtilization();
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include "SDL_scancode.h"
+
+namespace dae
+{
+	class Renderer;
+	class Timer;
+
+	//renders the latest published frame state on its own thread, so a slow frame doesn't stall the input handling
+	class RenderThread final
+	{
+	public:
+		using KeyHandler = std::function<void(SDL_Scancode scancode, Timer* pTimer)>;
+
+		RenderThread(Renderer* pRenderer, const KeyHandler& keyHandler);
+		~RenderThread();
+
+		RenderThread(const RenderThread& other) = delete;
+		RenderThread(RenderThread&& other) = delete;
+		RenderThread& operator=(const RenderThread& other) = delete;
+		RenderThread& operator=(RenderThread&& other) = delete;
+
+		//the key is handled on the render thread before its next frame, only call this from one thread
+		void QueueKey(SDL_Scancode scancode);
+
+	private:
+		Renderer* m_pRenderer;
+		KeyHandler m_KeyHandler;
+
+		//single producer single consumer ring buffer
+		static constexpr uint32_t m_KeyQueueSize{ 64 };
+		SDL_Scancode m_KeyQueue[m_KeyQueueSize]{};
+		std::atomic<uint32_t> m_KeyQueueHead{};
+		std::atomic<uint32_t> m_KeyQueueTail{};
+
+		std::atomic<bool> m_IsRunning{ true };
+		std::thread m_Thread;
+
+		void Run();
+	};
+}
\ No newline at end of file
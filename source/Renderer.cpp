@@ -5,6 +5,11 @@
 #include "OpaqueEffect.h"
 #include "OpaqueMesh.h"
 #include "PartialCoverageMesh.h"
+#include "ThreadPool.h"
+#include "AssetLoader.h"
+#include "Assets.h"
+#include <future>
+#include <thread>
 
 namespace dae {
 
@@ -43,31 +48,47 @@ namespace dae {
 		m_pLinearSampler = new Sampler(m_pDevice, Sampler::SamplerStateKind::linear);
 		m_pAnisotropicSampler = new Sampler(m_pDevice, Sampler::SamplerStateKind::anisotropic);
 
-		//create the meshes and change it samplerState
-		m_pFireFXMesh = new PartialCoverageMesh(m_pDevice, "Resources/fireFX.obj", L"Resources/fireFX.fx", static_cast<float>(m_Width), static_cast<float>(m_Height));
-		m_pVehicleMesh = new OpaqueMesh(m_pDevice, "Resources/vehicle.obj", L"Resources/vehicle.fx", OpaqueMesh::CullMode::BackFace, m_pPointSampler, static_cast<float>(m_Width), static_cast<float>(m_Height));
-		m_pVehicleMesh->SetRasterizerState(pRasterizerState);
-		
+		//the meshes, effects and textures don't depend on each other, so they are all loaded at the same time
+		//and startup takes as long as the slowest of them instead of all of them together
+		const uint64_t loadStartTicks{ SDL_GetPerformanceCounter() };
+		m_pAssetLoader = new AssetLoader();
+
+		const float width{ static_cast<float>(m_Width) };
+		const float height{ static_cast<float>(m_Height) };
+
+		std::future<PartialCoverageMesh*> fireFXMesh{ m_pAssetLoader->Load<PartialCoverageMesh>([this, width, height] { return new PartialCoverageMesh(m_pDevice, Assets::fireFXMesh.modelFilePath, L"Resources/fireFX.fx", width, height); }) };
+		std::future<OpaqueMesh*> vehicleMesh{ m_pAssetLoader->Load<OpaqueMesh>([this, width, height] { return new OpaqueMesh(m_pDevice, Assets::vehicleMesh.modelFilePath, L"Resources/vehicle.fx", OpaqueMesh::CullMode::BackFace, m_pPointSampler, width, height, Assets::vehicleMesh.vertexFormat); }) };
+
+		std::future<Texture*> fireFXDiffuse{ m_pAssetLoader->Load<Texture>([this] { return Texture::LoadFromFile(Assets::fireFXDiffuse.path, m_pDevice, Assets::fireFXDiffuse.format); }) };
+		std::future<Texture*> vehicleDiffuse{ m_pAssetLoader->Load<Texture>([this] { return Texture::LoadFromFile(Assets::vehicleDiffuse.path, m_pDevice, Assets::vehicleDiffuse.format); }) };
+		std::future<Texture*> material{ m_pAssetLoader->Load<Texture>([this] { return Texture::LoadPackedFromFiles(Assets::vehicleMaterial.channelSources, m_pDevice, Assets::vehicleMaterial.format); }) };
+
 		//initialize the camera
 		m_Camera.Initialize(45, { 0.f, 0.f, -50.f }, m_Width / static_cast<float>(m_Height));
 
-		//create texture
-		m_pFireFXDiffuse = Texture::LoadFromFile("Resources/fireFX_diffuse.png", m_pDevice);
-		m_pVehicleDiffuse = Texture::LoadFromFile("Resources/vehicle_diffuse.png", m_pDevice);
-		m_pNormal = Texture::LoadFromFile("Resources/vehicle_normal.png", m_pDevice);
-		m_pSpecular = Texture::LoadFromFile("Resources/vehicle_specular.png", m_pDevice);
-		m_pGlossiness = Texture::LoadFromFile("Resources/vehicle_gloss.png", m_pDevice);
+		//the loads run in parallel, but they are joined in a fixed order: binding is cheap and the first frame needs all of them,
+		//so waiting on a finished texture behind the meshes costs nothing, the constructor returns when the slowest asset is done
+		m_pFireFXMesh = fireFXMesh.get();
+		m_pVehicleMesh = vehicleMesh.get();
+		m_pVehicleMesh->SetRasterizerState(pRasterizerState);
 
+		m_pFireFXDiffuse = fireFXDiffuse.get();
 		m_pFireFXMesh->SetDiffuseMap(m_pFireFXDiffuse);
+
+		m_pVehicleDiffuse = vehicleDiffuse.get();
 		m_pVehicleMesh->SetDiffuseMap(m_pVehicleDiffuse);
-		m_pVehicleMesh->SetNormalMap(m_pNormal);
-		m_pVehicleMesh->SetSpecularMap(m_pSpecular);
-		m_pVehicleMesh->SetGlossinessMap(m_pGlossiness);
 
-		PrintInfo();
+		m_pMaterial = material.get();
+		m_pVehicleMesh->SetMaterialMap(m_pMaterial);
+
+		//the textures start with their small mip levels, the others are streamed in while rendering
+		m_pFireFXDiffuse->SetMemoryBudget(m_TextureMemoryBudget);
+		m_pVehicleDiffuse->SetMemoryBudget(m_TextureMemoryBudget);
+		m_pMaterial->SetMemoryBudget(m_TextureMemoryBudget);
+
+		std::cout << "Assets loaded in " << (SDL_GetPerformanceCounter() - loadStartTicks) * 1000.0 / SDL_GetPerformanceFrequency() << " ms\n";
 
-		if(m_RenderMode == RenderMode::hardware)
-			m_Camera.rotationSpeed *= 5;
+		PrintInfo();
 	}
 
 	Renderer::~Renderer()
@@ -103,33 +124,79 @@ namespace dae {
 
 		delete m_pFireFXDiffuse;
 		delete m_pVehicleDiffuse;
-		delete m_pNormal;
-		delete m_pSpecular;
-		delete m_pGlossiness;
+		delete m_pMaterial;
+
+		//after the textures, they wait for the levels that are still being cooked
+		delete m_pAssetLoader;
 
 		delete m_pFireFXMesh;
 		delete m_pVehicleMesh;
 
 		delete m_pDepthBufferPixels;
+
+		delete m_pThreadPool;
 	}
 
 	void Renderer::Update(const Timer* pTimer)
 	{
+		const RenderMode renderMode{ m_RenderMode };
+
+		if (renderMode != m_CameraRenderMode)
+		{
+			if (renderMode == RenderMode::hardware)
+				m_Camera.rotationSpeed *= 5;
+			else
+				m_Camera.rotationSpeed /= 5;
+
+			m_CameraRenderMode = renderMode;
+		}
+
 		m_Camera.Update(pTimer);
 
 		if (m_IsRotating)
 		{
-			m_pFireFXMesh->RotateYCW(m_pFireFXMesh->GetRotationAngle() + pTimer->GetElapsed() * m_pFireFXMesh->GetRotationSpeed());
-			m_pVehicleMesh->RotateYCW(m_pVehicleMesh->GetRotationAngle() + pTimer->GetElapsed() * m_pVehicleMesh->GetRotationSpeed());
+			m_FireFXRotationAngle += pTimer->GetElapsed() * m_pFireFXMesh->GetRotationSpeed();
+			m_VehicleRotationAngle += pTimer->GetElapsed() * m_pVehicleMesh->GetRotationSpeed();
 		}
 
-		m_pFireFXMesh->SetWorldViewProjMatrix(m_pFireFXMesh->GetWorldMatrix() * m_Camera.viewMatrix * m_Camera.projectionMatrix);
-		m_pVehicleMesh->SetWorldViewProjMatrix(m_pVehicleMesh->GetWorldMatrix() * m_Camera.viewMatrix * m_Camera.projectionMatrix);
-		m_pVehicleMesh->SetViewInverseMatrix(m_Camera.invViewMatrix);
+		FrameState& frameState{ m_FrameStates.GetWriteBuffer() };
+		frameState.cameraOrigin = m_Camera.origin;
+		frameState.viewMatrix = m_Camera.viewMatrix;
+		frameState.invViewMatrix = m_Camera.invViewMatrix;
+		frameState.projectionMatrix = m_Camera.projectionMatrix;
+		frameState.vehicleRotationAngle = m_VehicleRotationAngle;
+		frameState.fireFXRotationAngle = m_FireFXRotationAngle;
+		m_FrameStates.Publish();
+	}
+
+	void Renderer::ApplyLatestFrameState()
+	{
+		if (!m_FrameStates.Consume())
+			return;
+
+		const FrameState& frameState{ m_FrameStates.GetReadBuffer() };
+
+		m_RenderCamera.origin = frameState.cameraOrigin;
+		m_RenderCamera.viewMatrix = frameState.viewMatrix;
+		m_RenderCamera.invViewMatrix = frameState.invViewMatrix;
+		m_RenderCamera.projectionMatrix = frameState.projectionMatrix;
+
+		m_pFireFXMesh->RotateYCW(frameState.fireFXRotationAngle);
+		m_pVehicleMesh->RotateYCW(frameState.vehicleRotationAngle);
+		m_pFireFXMesh->UpdateLevelOfDetail(m_RenderCamera);
+		m_pVehicleMesh->UpdateLevelOfDetail(m_RenderCamera);
+
+		//the world matrices come from the instance buffers of the meshes
+		m_pFireFXMesh->SetViewProjMatrix(m_RenderCamera.viewMatrix * m_RenderCamera.projectionMatrix);
+		m_pVehicleMesh->SetViewProjMatrix(m_RenderCamera.viewMatrix * m_RenderCamera.projectionMatrix);
+		m_pVehicleMesh->SetViewInverseMatrix(m_RenderCamera.invViewMatrix);
 	}
 
-	void Renderer::Render() const
+	void Renderer::Render()
 	{
+		ApplyLatestFrameState();
+		UpdateTextureResidency();
+
 		switch (m_RenderMode)
 		{
 		case dae::Renderer::RenderMode::hardware:
@@ -142,6 +209,50 @@ namespace dae {
 		}
 	}
 
+	bool Renderer::UpdateTextureResidency()
+	{
+		//size of the bounding sphere of the nearest instance of the mesh on screen, the textures are spread over the whole model
+		const auto calculateScreenSize = [this](const Mesh* pMesh)
+		{
+			const float distance{ std::max(pMesh->CalculateNearestInstanceDistance(m_RenderCamera.origin), pMesh->GetBoundingRadius()) };
+			return pMesh->GetBoundingRadius() / distance * m_RenderCamera.projectionMatrix[1][1] * m_Height;
+		};
+
+		const float fireFXScreenSize{ calculateScreenSize(m_pFireFXMesh) };
+		const float vehicleScreenSize{ calculateScreenSize(m_pVehicleMesh) };
+
+		bool hasChanged{ false };
+
+		if (m_pFireFXDiffuse->UpdateResidency(m_pDevice, m_pDeviceContext, *m_pAssetLoader, fireFXScreenSize))
+		{
+			m_pFireFXMesh->SetDiffuseMap(m_pFireFXDiffuse);
+			hasChanged = true;
+		}
+
+		if (m_pVehicleDiffuse->UpdateResidency(m_pDevice, m_pDeviceContext, *m_pAssetLoader, vehicleScreenSize))
+		{
+			m_pVehicleMesh->SetDiffuseMap(m_pVehicleDiffuse);
+			hasChanged = true;
+		}
+
+		if (m_pMaterial->UpdateResidency(m_pDevice, m_pDeviceContext, *m_pAssetLoader, vehicleScreenSize))
+		{
+			m_pVehicleMesh->SetMaterialMap(m_pMaterial);
+			hasChanged = true;
+		}
+
+		return hasChanged;
+	}
+
+	void Renderer::FinishTextureStreaming()
+	{
+		//the asset loader cooks and prepares the levels in the background, so a call can change nothing while there's more to come
+		while (UpdateTextureResidency() || m_pFireFXDiffuse->IsStreaming() || m_pVehicleDiffuse->IsStreaming() || m_pMaterial->IsStreaming())
+		{
+			std::this_thread::yield();
+		}
+	}
+
 	void Renderer::InitializeSoftwareRasterizer()
 	{
 		//Create Buffers
@@ -151,6 +262,8 @@ namespace dae {
 
 		const int amountOfPixels{ m_Width * m_Height };
 		m_pDepthBufferPixels = new float[amountOfPixels];
+
+		CreateThreadPool();
 		//fill depth buffer with ifiniy as value
 		for (int index{}; index < amountOfPixels; ++index)
 		{
@@ -158,7 +271,68 @@ namespace dae {
 		}
 	}
 
-	void Renderer::RenderInSoftwareRasterizer() const
+	void Renderer::CreateThreadPool()
+	{
+		delete m_pThreadPool;
+
+		//the geometry of the next pipelined frame is prepared on its own thread while the pool rasterizes,
+		//so the pool leaves a core free for it instead of oversubscribing the cores
+		const uint32_t amountOfCores{ std::max(std::thread::hardware_concurrency(), 1u) };
+		m_pThreadPool = new ThreadPool(m_UsePipelinedRendering ? std::max(amountOfCores - 1, 1u) : amountOfCores);
+	}
+
+	void Renderer::RenderInSoftwareRasterizer()
+	{
+		if (!m_UsePipelinedRendering)
+		{
+			RenderSoftwareFrame(m_pThreadPool);
+		}
+		else
+		{
+			const uint32_t frameIndex{ m_SoftwareFrameIndex };
+			const uint32_t nextFrameIndex{ (m_SoftwareFrameIndex + 1) % Mesh::m_AmountOfSoftwareFrames };
+
+			//fill the pipeline
+			if (!m_HasPreparedSoftwareFrame)
+			{
+				PrepareSoftwareFrame(frameIndex);
+				m_HasPreparedSoftwareFrame = true;
+			}
+
+			//the geometry of the next frame uses the camera and world matrices of the latest update,
+			//those are only changed again after this function waited for it
+			std::future<void> nextFrameGeometry{ std::async(std::launch::async, [this, nextFrameIndex] { PrepareSoftwareFrame(nextFrameIndex); }) };
+
+			RasterizeSoftwareFrame(m_pThreadPool, frameIndex);
+
+			SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
+			SDL_UpdateWindowSurface(m_pWindow);
+
+			nextFrameGeometry.get();
+			m_SoftwareFrameIndex = nextFrameIndex;
+			return;
+		}
+
+		SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
+		SDL_UpdateWindowSurface(m_pWindow);
+	}
+
+	void Renderer::RenderSoftwareFrame(ThreadPool* pThreadPool) const
+	{
+		PrepareSoftwareFrame(m_SoftwareFrameIndex);
+		RasterizeSoftwareFrame(pThreadPool, m_SoftwareFrameIndex);
+	}
+
+	void Renderer::PrepareSoftwareFrame(uint32_t frameIndex) const
+	{
+		m_pVehicleMesh->PrepareSoftwareFrame(m_RenderCamera, frameIndex);
+
+		//a pipelined frame is prepared before it is known if the fireFX will be on when it is rasterized
+		if (m_RenderFireFX || m_UsePipelinedRendering)
+			m_pFireFXMesh->PrepareSoftwareFrame(m_RenderCamera, frameIndex);
+	}
+
+	void Renderer::RasterizeSoftwareFrame(ThreadPool* pThreadPool, uint32_t frameIndex) const
 	{
 		//@START
 		if (m_UseUniformClearColor)
@@ -175,16 +349,125 @@ namespace dae {
 		//Lock BackBuffer
 		SDL_LockSurface(m_pBackBuffer);
 
-		m_pVehicleMesh->RenderSoftware(m_Camera, m_pDepthBufferPixels, m_pBackBuffer, m_pBackBufferPixels);
+		m_pVehicleMesh->RasterizeSoftwareFrame(pThreadPool, frameIndex, m_pDepthBufferPixels, m_pBackBuffer, m_pBackBufferPixels);
 
 		if(m_RenderFireFX)
-			m_pFireFXMesh->RenderSoftware(m_Camera, m_pDepthBufferPixels, m_pBackBuffer, m_pBackBufferPixels);
+			m_pFireFXMesh->RasterizeSoftwareFrame(pThreadPool, frameIndex, m_pDepthBufferPixels, m_pBackBuffer, m_pBackBufferPixels);
 
 		//@END
-	//Update SDL Surface
 		SDL_UnlockSurface(m_pBackBuffer);
-		SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
-		SDL_UpdateWindowSurface(m_pWindow);
+	}
+
+	uint64_t Renderer::HashSoftwareFrame() const
+	{
+		uint64_t hash{ Utils::HashBytes(m_pDepthBufferPixels, sizeof(float) * m_Width * m_Height) };
+
+		//hash row by row because the surface rows can be padded
+		for (int row{}; row < m_Height; ++row)
+		{
+			hash = Utils::HashBytes(static_cast<const uint8_t*>(m_pBackBuffer->pixels) + row * m_pBackBuffer->pitch, sizeof(uint32_t) * m_Width, hash);
+		}
+
+		return hash;
+	}
+
+	bool Renderer::CheckDeterministicSoftwareRendering()
+	{
+		ApplyLatestFrameState();
+
+		//stream in everything first, the result shouldn't depend on how many frames were rendered before
+		FinishTextureStreaming();
+
+		constexpr int amountOfMultiThreadedRuns{ 3 };
+
+		ThreadPool singleThreadPool{ 1 };
+		RenderSoftwareFrame(&singleThreadPool);
+		const uint64_t referenceHash{ HashSoftwareFrame() };
+
+		std::cout << "Software frame hash with 1 thread: " << std::hex << referenceHash << std::dec << '\n';
+
+		bool isDeterministic{ true };
+
+		for (int run{}; run < amountOfMultiThreadedRuns; ++run)
+		{
+			RenderSoftwareFrame(m_pThreadPool);
+			const uint64_t hash{ HashSoftwareFrame() };
+
+			std::cout << "Software frame hash with " << m_pThreadPool->GetAmountOfThreads() << " threads: " << std::hex << hash << std::dec << '\n';
+
+			if (hash != referenceHash)
+				isDeterministic = false;
+		}
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), isDeterministic ? 2 : 4); //set console text color to green or red
+
+		if (isDeterministic)
+			std::cout << "Software rasterizer output is deterministic\n";
+		else
+			std::cout << "Software rasterizer output differs between runs!\n";
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 15); //set console text color to white
+
+		return isDeterministic;
+	}
+
+	void Renderer::BenchmarkSoftwareRendering(int amountOfFrames)
+	{
+		ApplyLatestFrameState();
+
+		//stream in everything first, the result shouldn't depend on how many frames were rendered before
+		FinishTextureStreaming();
+
+		//one thread, so the frame times show the memory access patterns and not the scheduling
+		ThreadPool singleThreadPool{ 1 };
+		const float startRotationAngle{ m_pVehicleMesh->GetRotationAngle() };
+
+		uint64_t totalTicks{};
+		uint64_t slowestTicks{};
+		uint64_t fastestTicks{ UINT64_MAX };
+
+		for (int frame{}; frame < amountOfFrames; ++frame)
+		{
+			m_pVehicleMesh->RotateYCW(startRotationAngle + 2.f * PI * frame / amountOfFrames);
+
+			const uint64_t startTicks{ SDL_GetPerformanceCounter() };
+			RenderSoftwareFrame(&singleThreadPool);
+			const uint64_t elapsedTicks{ SDL_GetPerformanceCounter() - startTicks };
+
+			totalTicks += elapsedTicks;
+			slowestTicks = std::max(slowestTicks, elapsedTicks);
+			fastestTicks = std::min(fastestTicks, elapsedTicks);
+		}
+
+		m_pVehicleMesh->RotateYCW(startRotationAngle);
+
+		const double millisecondsPerTick{ 1000.0 / SDL_GetPerformanceFrequency() };
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 2); //set console text color to green
+
+		std::cout << "Software benchmark, " << amountOfFrames << " frames of a rotating vehicle:\n";
+		std::cout << "\taverage: " << totalTicks * millisecondsPerTick / amountOfFrames << " ms\n";
+		std::cout << "\tfastest: " << fastestTicks * millisecondsPerTick << " ms\n";
+		std::cout << "\tslowest: " << slowestTicks * millisecondsPerTick << " ms\n";
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 15); //set console text color to white
+	}
+
+	void Renderer::PrintThreadUtilization()
+	{
+		if (m_RenderMode == RenderMode::software)
+		{
+			std::cout << "Thread utilization:";
+
+			for (uint32_t workerIndex{}; workerIndex < m_pThreadPool->GetAmountOfThreads(); ++workerIndex)
+			{
+				std::cout << ' ' << static_cast<int>(m_pThreadPool->GetUtilization(workerIndex) * 100.f) << '%';
+			}
+
+			std::cout << '\n';
+		}
+
+		m_pThreadPool->ResetUtilization();
 	}
 
 	HRESULT Renderer::InitializeDirectX()
@@ -350,10 +633,7 @@ namespace dae {
 
 	void Renderer::ChangeSamplerState()
 	{
-		if (m_RenderMode == RenderMode::software)
-			return;
-
-		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 2); //set console text color to green
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 6); //set console text color to orange
 
 		switch (m_pVehicleMesh->GetSamplerStateKind())
 		{
@@ -421,14 +701,13 @@ namespace dae {
 		{
 		case RenderMode::hardware:
 			m_RenderMode = RenderMode::software;
+			m_HasPreparedSoftwareFrame = false;
 			std::cout << "Rasterizer Mode = SOFTWARE\n";
-			m_Camera.rotationSpeed /= 5;
 			break;
 
 		case RenderMode::software:
 			m_RenderMode = RenderMode::hardware;
 			std::cout << "Rasterizer Mode = HARDWARE\n";
-			m_Camera.rotationSpeed *= 5;
 			break;
 		}
 
@@ -463,6 +742,55 @@ namespace dae {
 		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 15); //set console text color to white
 	}
 
+	void Renderer::TogglePipelinedRendering()
+	{
+		m_UsePipelinedRendering = !m_UsePipelinedRendering;
+		m_HasPreparedSoftwareFrame = false;
+		CreateThreadPool();
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 5); //set console text color to purple
+
+		if (m_UsePipelinedRendering)
+			std::cout << "Pipelined Rendering On\n";
+		else
+			std::cout << "Pipelined Rendering Off\n";
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 15); //set console text color to white
+	}
+
+	void Renderer::ToggleFleet()
+	{
+		m_RenderFleet = !m_RenderFleet;
+
+		//a grid of vehicles that starts at the single one and goes away from the camera, they share the geometry of one mesh
+		std::vector<Matrix> instanceTransforms{};
+		const int amountPerSide{ m_RenderFleet ? m_FleetSize : 1 };
+		const float spacing{ 2.5f * m_pVehicleMesh->GetBoundingRadius() };
+
+		for (int row{}; row < amountPerSide; ++row)
+		{
+			for (int column{}; column < amountPerSide; ++column)
+			{
+				instanceTransforms.push_back(Matrix::CreateTranslation((column - (amountPerSide - 1) / 2.f) * spacing, 0.f, row * spacing));
+			}
+		}
+
+		m_pVehicleMesh->SetInstanceTransforms(m_pDevice, instanceTransforms);
+		m_pFireFXMesh->SetInstanceTransforms(m_pDevice, instanceTransforms);
+
+		//the software frames are resized for the new amount of instances
+		m_HasPreparedSoftwareFrame = false;
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 6); //set console text color to orange
+
+		if (m_RenderFleet)
+			std::cout << "Fleet of " << instanceTransforms.size() << " vehicles On\n";
+		else
+			std::cout << "Fleet Off\n";
+
+		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 15); //set console text color to white
+	}
+
 	void Renderer::ToggleFireFX()
 	{
 		m_RenderFireFX = !m_RenderFireFX;
@@ -514,15 +842,12 @@ namespace dae {
 		std::cout << "\tToggle between DirectX & Software Rasterizer [F1]\n";
 		std::cout << "\tToggle Rotation (On/Off) [F2]\n";
 		std::cout << "\tToggle FireFX mesh (On/Off) [F3]\n";
+		std::cout << "\tToggle Fleet of vehicles (On/Off) [I]\n";
+		std::cout << "\tToggle between Texture Sampling States (point-linear-anisotropic) [F4]\n";
 		std::cout << "\tCycle Cull Modes (back-face, front-face, none) [F9]\n";
 		std::cout << "\tToggle Uniform ClearColor [F10]\n";
 		std::cout << "\tToggle Print FPS (On/Off) [F11]\n";
 
-		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 2); //set console text color to green
-
-		std::cout << "\n\tHARDWARE ONLY:\n";
-		std::cout << "\tToggle between Texture Sampling States (point-linear-anisotropic) [F4]\n";
-
 		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 5); //set console text color to purple
 
 		std::cout << "\n\tSOFTWARE ONLY:\n";
@@ -530,6 +855,7 @@ namespace dae {
 		std::cout << "\tToggle NormalMap (On/Off) [F6]\n";
 		std::cout << "\tToggle DepthBuffer Visualization (On/Off) [F7]\n";
 		std::cout << "\tToggle BoundingBox Visualization (On/Off) [F8]\n";
+		std::cout << "\tToggle Pipelined Rendering (On/Off) [P]\n";
 
 		SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), 15); //set console text color to white
 	}
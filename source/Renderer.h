@@ -1,6 +1,8 @@
 #pragma once
 #include "Camera.h"
 #include "Texture.h"
+#include "TripleBuffer.h"
+#include <atomic>
 
 struct SDL_Window;
 struct SDL_Surface;
@@ -11,6 +13,8 @@ namespace dae
 	class Mesh;
 	class OpaqueMesh;
 	class PartialCoverageMesh;
+	class ThreadPool;
+	class AssetLoader;
 
 	class Renderer final
 	{
@@ -23,11 +27,15 @@ namespace dae
 		Renderer& operator=(const Renderer&) = delete;
 		Renderer& operator=(Renderer&&) noexcept = delete;
 
+		//Update and Render can run on different threads: Update publishes a frame state that Render picks up,
+		//all the other functions have to be called on the thread that renders
 		void Update(const Timer* pTimer);
-		void Render() const;
+		void Render();
 		void CycleRenderModes();
 		void ToggleIsRotating();
 		void ToggleFireFX();
+		//renders the vehicle and its fireFX as a grid of instances
+		void ToggleFleet();
 		void ChangeSamplerState();
 		void CycleShadingMode();
 		void ToggleNormalMap();
@@ -35,6 +43,13 @@ namespace dae
 		void ToggleBoundingBoxVisualization();
 		void CycleCullModes();
 		void ToggleUseUniformClearColor();
+		void TogglePipelinedRendering();
+		//renders the same software frame with 1 and with all threads and compares the hashes of the results
+		bool CheckDeterministicSoftwareRendering();
+		//renders a full turn of the vehicle in software on a single thread and prints the frame times
+		void BenchmarkSoftwareRendering(int amountOfFrames);
+		//prints how busy every software rasterizer thread was since the last call
+		void PrintThreadUtilization();
 		
 	private:
 		SDL_Window* m_pWindow{};
@@ -42,7 +57,21 @@ namespace dae
 		int m_Width{};
 		int m_Height{};
 
+		//everything the render side needs from an update
+		struct FrameState
+		{
+			Vector3 cameraOrigin;
+			Matrix viewMatrix;
+			Matrix invViewMatrix;
+			Matrix projectionMatrix;
+			float vehicleRotationAngle;
+			float fireFXRotationAngle;
+		};
+
+		//m_Camera is updated by Update, m_RenderCamera holds the state of the frame that is being rendered
 		Camera m_Camera{};
+		Camera m_RenderCamera{};
+		TripleBuffer<FrameState> m_FrameStates;
 
 		bool m_DirectXIsInitialized{ false };
 
@@ -62,9 +91,12 @@ namespace dae
 		//Textures
 		Texture* m_pFireFXDiffuse;
 		Texture* m_pVehicleDiffuse;
-		Texture* m_pNormal;
-		Texture* m_pSpecular;
-		Texture* m_pGlossiness;
+		Texture* m_pMaterial;
+
+		//loads the assets at startup and cooks the detailed mip levels of the textures while rendering
+		AssetLoader* m_pAssetLoader{};
+		//per texture, the material map needs about 5.6 MB for all its levels
+		static constexpr size_t m_TextureMemoryBudget{ 8 * 1024 * 1024 };
 
 		OpaqueMesh* m_pVehicleMesh{};
 		PartialCoverageMesh* m_pFireFXMesh{};
@@ -77,6 +109,8 @@ namespace dae
 
 		float* m_pDepthBufferPixels{};
 
+		ThreadPool* m_pThreadPool{};
+
 		ColorRGBA m_UniformClearColor{ 0.1f, 0.1f, 0.1f };
 
 		enum class RenderMode
@@ -85,16 +119,41 @@ namespace dae
 			software
 		};
 
-		RenderMode m_RenderMode{ RenderMode::hardware };
+		std::atomic<RenderMode> m_RenderMode{ RenderMode::hardware };
+		//render mode the camera speed is set up for, the camera rotates faster in hardware mode
+		RenderMode m_CameraRenderMode{ RenderMode::software };
 
 		bool m_IsRotating{ true };
+		float m_VehicleRotationAngle{};
+		float m_FireFXRotationAngle{};
 		bool m_UseUniformClearColor{ false };
 		bool m_RenderFireFX{ true };
+		bool m_RenderFleet{ false };
+		//vehicles per side of the fleet grid
+		static constexpr int m_FleetSize{ 3 };
+
+		//pipelined software rendering prepares the geometry of the next frame while the current one is rasterized and presented
+		//this shows every frame one frame later, but keeps the threads busy during the whole frame
+		bool m_UsePipelinedRendering{ false };
+		bool m_HasPreparedSoftwareFrame{ false };
+		uint32_t m_SoftwareFrameIndex{};
 
 		void PrintInfo();
+		void ApplyLatestFrameState();
+		//streams in the mip levels the meshes need at their size on screen and evicts the ones they don't
+		//returns false when every texture already had the levels it needs
+		bool UpdateTextureResidency();
+		//streams in every level the textures need now, including the ones that still have to be cooked
+		void FinishTextureStreaming();
 
 		void InitializeSoftwareRasterizer();
-		void RenderInSoftwareRasterizer() const;
+		//one thread per core, one less while pipelining
+		void CreateThreadPool();
+		void RenderInSoftwareRasterizer();
+		void RenderSoftwareFrame(ThreadPool* pThreadPool) const;
+		void PrepareSoftwareFrame(uint32_t frameIndex) const;
+		void RasterizeSoftwareFrame(ThreadPool* pThreadPool, uint32_t frameIndex) const;
+		uint64_t HashSoftwareFrame() const;
 
 		//DIRECTX
 		HRESULT InitializeDirectX();
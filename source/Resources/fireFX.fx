@@ -3,6 +3,7 @@ struct VS_INPUT
 {
 	float3 Position : POSITION;
 	float2 TextCoord : TEXTCOORD;
+	row_major float4x4 World : WORLD; //per instance, the rows of a dae::Matrix as they are in the instance buffer
 };
 
 struct VS_OUTPUT
@@ -58,14 +59,14 @@ SamplerState gSamplerState : Sampler
 	AddressV = Wrap;
 };
 
-float4x4 gWorldViewProj : WorldViewProjection;
+float4x4 gViewProj : ViewProjection;
 Texture2D gDiffuseMap : DiffuseMap;
 
 // Vertex Shader
 VS_OUTPUT VS(VS_INPUT input)
 {
 	VS_OUTPUT output = (VS_OUTPUT)0;
-	output.Position = mul(float4(input.Position, 1.f), gWorldViewProj);
+	output.Position = mul(mul(float4(input.Position, 1.f), input.World), gViewProj);
 	output.TextCoord = input.TextCoord;
 	return output;
 }
@@ -4,7 +4,18 @@ struct VS_INPUT
 	float3 Position : POSITION;
 	float2 TextCoord : TEXTCOORD;
 	float3 Normal : NORMAL;
-	float3 Tangent : TANGENT;
+	float4 Tangent : TANGENT; //w is -1 where the uvs are mirrored
+	row_major float4x4 World : WORLD; //per instance, the rows of a dae::Matrix as they are in the instance buffer
+};
+
+//Mesh::CompactVertex_In, the input assembler already turns the unorm, snorm and half values into floats
+struct VS_INPUT_COMPACT
+{
+	float4 Position : POSITION; //0 to 1 within the bounds of the mesh, w is 0 for a tangent sign of -1 and 1 for 1
+	float2 TextCoord : TEXTCOORD;
+	float2 Normal : NORMAL; //octahedral
+	float2 Tangent : TANGENT; //octahedral
+	row_major float4x4 World : WORLD; //per instance, the rows of a dae::Matrix as they are in the instance buffer
 };
 
 struct VS_OUTPUT
@@ -14,6 +25,7 @@ struct VS_OUTPUT
 	float2 TextCoord : TEXTCOORD;
 	float3 Normal : NORMAL;
 	float3 Tangent : TANGENT;
+	float3 Binormal : BINORMAL;
 };
 
 BlendState gBlendState
@@ -52,13 +64,12 @@ DepthStencilState gDepthStencilState
 };
 
 SamplerState gSamplerState : Sampler;
-float4x4 gWorld : World;
-float4x4 gWorldViewProj : WorldViewProjection;
+float4x4 gViewProj : ViewProjection;
 float4x4 gViewInverse : ViewInverse;
+float3 gPositionOffset : PositionOffset; //minimum of the mesh bounds
+float3 gPositionScale : PositionScale; //extent of the mesh bounds
 Texture2D gDiffuseMap : DiffuseMap;
-Texture2D gNormalMap : NormalMap;
-Texture2D gSpecularMap : SpecularMap;
-Texture2D gGlossinessMap : GlossinessMap;
+Texture2D gMaterialMap : MaterialMap; //normal x and y, specular, glossiness
 float3 gLightDirection = float3(0.577f, -0.577f, 0.577f);
 float gPI = 3.14159265358979f;
 float gLightIntensity = 7.f;
@@ -70,14 +81,34 @@ float4 gAmbient = float4(0.025f, 0.025f, 0.025f, 1.f);
 VS_OUTPUT VS(VS_INPUT input)
 {
 	VS_OUTPUT output = (VS_OUTPUT)0;
-	output.Position = mul(float4(input.Position, 1.f), gWorldViewProj);
-	output.WorldPosition = mul(float4(input.Position, 1.f), gWorld);
-	output.Normal = mul(normalize(input.Normal), (float3x3)gWorld);
-	output.Tangent = mul(normalize(input.Tangent), (float3x3)gWorld); 
+	output.WorldPosition = mul(float4(input.Position, 1.f), input.World);
+	output.Position = mul(output.WorldPosition, gViewProj);
+	output.Normal = mul(normalize(input.Normal), (float3x3)input.World);
+	output.Tangent = mul(normalize(input.Tangent.xyz), (float3x3)input.World);
+	output.Binormal = mul(cross(normalize(input.Normal), normalize(input.Tangent.xyz)) * input.Tangent.w, (float3x3)input.World);
 	output.TextCoord = input.TextCoord;
 	return output;
 }
 
+float3 DecodeOctahedral(float2 encoded)
+{
+	float3 direction = float3(encoded, 1.f - abs(encoded.x) - abs(encoded.y));
+	float fold = saturate(-direction.z);
+	direction.xy += direction.xy >= 0.f ? -fold : fold;
+	return normalize(direction);
+}
+
+VS_OUTPUT VS_Compact(VS_INPUT_COMPACT input)
+{
+	VS_INPUT decoded = (VS_INPUT)0;
+	decoded.Position = gPositionOffset + input.Position.xyz * gPositionScale;
+	decoded.TextCoord = input.TextCoord;
+	decoded.Normal = DecodeOctahedral(input.Normal);
+	decoded.Tangent = float4(DecodeOctahedral(input.Tangent), input.Position.w * 2.f - 1.f);
+	decoded.World = input.World;
+	return VS(decoded);
+}
+
 float4 Diffuse(float kd, float4 cd)
 {
 	return cd * kd / gPI;
@@ -91,18 +122,21 @@ float Phong(float ks, float exp, float3 l, float3 v, float3 n)
 // Pixel Shader
 float4 PS(VS_OUTPUT input) : SV_TARGET
 {
-	float3 binormal = cross(input.Normal, input.Tangent);
+	float3x3 tangentSpaceAxis = float3x3(input.Tangent, input.Binormal, input.Normal);
 
-	float3x3 tangentSpaceAxis = float3x3(input.Tangent, binormal, input.Normal);
+	float4 material = gMaterialMap.Sample(gSamplerState, input.TextCoord);
 
-	float3 sampledNormal = mul(normalize(2.f * gNormalMap.Sample(gSamplerState, input.TextCoord).xyz - 1.f), tangentSpaceAxis).xyz;
+	//only x and y of the normal are stored, z follows from the normal having length 1
+	float2 sampledNormalXY = 2.f * material.xy - 1.f;
+	float3 sampledNormal = float3(sampledNormalXY, sqrt(saturate(1.f - dot(sampledNormalXY, sampledNormalXY))));
+	sampledNormal = mul(normalize(sampledNormal), tangentSpaceAxis).xyz;
 	
 	float observedArea = saturate(dot(sampledNormal, -gLightDirection));
 
 	float3 viewDirection = normalize(input.WorldPosition.xyz - gViewInverse[3].xyz);
 	
 	float4 diffuse = gLightIntensity * Diffuse(1.f, gDiffuseMap.Sample(gSamplerState, input.TextCoord));
-	float4 specular = gSpecularMap.Sample(gSamplerState, input.TextCoord) * Phong(1.f, gShininess * gGlossinessMap.Sample(gSamplerState, input.TextCoord).r, -gLightDirection, viewDirection, sampledNormal);
+	float4 specular = float4(material.zzz, 1.f) * Phong(1.f, gShininess * material.w, -gLightDirection, viewDirection, sampledNormal);
 	
 	return observedArea * (diffuse + specular + gAmbient);
 }
@@ -118,4 +152,16 @@ technique11 DefaultTechnique
 		SetGeometryShader( NULL );
 		SetPixelShader( CompileShader( ps_5_0, PS() ) );
 	}
+}
+
+technique11 CompactTechnique
+{
+	pass P0
+	{
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.f, 0.f, 0.f, 0.f), 0xFFFFFFFF);
+		SetVertexShader( CompileShader( vs_5_0, VS_Compact() ) );
+		SetGeometryShader( NULL );
+		SetPixelShader( CompileShader( ps_5_0, PS() ) );
+	}
 }
\ No newline at end of file
@@ -2,8 +2,9 @@
 #include "Sampler.h"
 #include <cassert>
 
-Sampler::Sampler(ID3D11Device* pDevice, SamplerStateKind samplerStateKind)
+Sampler::Sampler(ID3D11Device* pDevice, SamplerStateKind samplerStateKind, AddressMode addressMode)
 	: m_SamplerStateKind{ samplerStateKind }
+	, m_AddressMode{ addressMode }
 {
 	D3D11_SAMPLER_DESC samplerDesc{};
 
@@ -22,11 +23,28 @@ Sampler::Sampler(ID3D11Device* pDevice, SamplerStateKind samplerStateKind)
 		break;
 	}
 
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	D3D11_TEXTURE_ADDRESS_MODE textureAddressMode{};
+
+	switch (addressMode)
+	{
+	case AddressMode::wrap:
+		textureAddressMode = D3D11_TEXTURE_ADDRESS_WRAP;
+		break;
+
+	case AddressMode::clamp:
+		textureAddressMode = D3D11_TEXTURE_ADDRESS_CLAMP;
+		break;
+
+	case AddressMode::mirror:
+		textureAddressMode = D3D11_TEXTURE_ADDRESS_MIRROR;
+		break;
+	}
+
+	samplerDesc.AddressU = textureAddressMode;
+	samplerDesc.AddressV = textureAddressMode;
+	samplerDesc.AddressW = textureAddressMode;
 	samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-	samplerDesc.MaxAnisotropy = 16;
+	samplerDesc.MaxAnisotropy = m_MaxAnisotropy;
 	samplerDesc.MinLOD = 0;
 	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
 	samplerDesc.MipLODBias = 0;
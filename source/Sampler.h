@@ -11,10 +11,21 @@ public:
 		anisotropic
 	};
 
-	Sampler(ID3D11Device* pDevice, SamplerStateKind samplerStateKind);
+	//what happens with uv outside [0, 1]
+	enum class AddressMode
+	{
+		wrap,
+		clamp,
+		mirror
+	};
+
+	Sampler(ID3D11Device* pDevice, SamplerStateKind samplerStateKind, AddressMode addressMode = AddressMode::wrap);
 	~Sampler();
 	ID3D11SamplerState* GetSamplerState() const { return m_pSamplerState; }
 	SamplerStateKind GetSamplerStateKind() const { return m_SamplerStateKind; }
+	AddressMode GetAddressMode() const { return m_AddressMode; }
+
+	static constexpr int m_MaxAnisotropy{ 16 };
 
 	Sampler(const Sampler& other) = delete;
 	Sampler(Sampler&& other) = delete;
@@ -24,4 +35,5 @@ public:
 private:
 	ID3D11SamplerState* m_pSamplerState{};
 	const SamplerStateKind m_SamplerStateKind{};
+	const AddressMode m_AddressMode{};
 };
\ No newline at end of file
@@ -1,21 +1,431 @@
 #include "pch.h"
 #include "Texture.h"
 #include "Vector2.h"
+#include "BlockCompression.h"
+#include "MappedFile.h"
+#include "AssetLoader.h"
+#include "Utils.h"
 #include <cassert>
+#include <atomic>
+#include <chrono>
+
+//SSE2 is always available on x64, other targets use the scalar fallback
+#if defined(_M_X64) || defined(__SSE2__)
+#define TEXTURE_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace dae
 {
-	Texture::Texture(SDL_Surface* pSurface, ID3D11Device* pDevice)
-		: m_pSurface{ pSurface }
-		, m_pSurfacePixels{ (uint32_t*)pSurface->pixels }
+	namespace
+	{
+		//the filters work on unnormalized channel values [0, 255] and only normalize the final color
+#ifdef TEXTURE_USE_SSE2
+		using TexelColor = __m128;
+
+		TexelColor LoadTexel(uint32_t texel)
+		{
+			const __m128i zero{ _mm_setzero_si128() };
+			const __m128i channels{ _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(texel)), zero), zero) };
+			return _mm_cvtepi32_ps(channels);
+		}
+
+		TexelColor LerpTexelColor(TexelColor color0, TexelColor color1, float factor)
+		{
+			return _mm_add_ps(color0, _mm_mul_ps(_mm_sub_ps(color1, color0), _mm_set1_ps(factor)));
+		}
+
+		TexelColor AddTexelColor(TexelColor color0, TexelColor color1)
+		{
+			return _mm_add_ps(color0, color1);
+		}
+
+		ColorRGBA ToColorRGBA(TexelColor color, float scale)
+		{
+			alignas(16) float channels[4];
+			_mm_store_ps(channels, _mm_mul_ps(color, _mm_set1_ps(scale / 255.f)));
+			return { channels[0], channels[1], channels[2], channels[3] };
+		}
+#else
+		using TexelColor = ColorRGBA;
+
+		TexelColor LoadTexel(uint32_t texel)
+		{
+			return
+			{
+				static_cast<float>(texel & 0xFF),
+				static_cast<float>(texel >> 8 & 0xFF),
+				static_cast<float>(texel >> 16 & 0xFF),
+				static_cast<float>(texel >> 24)
+			};
+		}
+
+		TexelColor LerpTexelColor(const TexelColor& color0, const TexelColor& color1, float factor)
+		{
+			return ColorRGBA::Lerp(color0, color1, factor);
+		}
+
+		TexelColor AddTexelColor(const TexelColor& color0, const TexelColor& color1)
+		{
+			return color0 + color1;
+		}
+
+		ColorRGBA ToColorRGBA(const TexelColor& color, float scale)
+		{
+			return color * (scale / 255.f);
+		}
+#endif
+
+		//the texels are stored in tiles of 8x8, row by row, and in Z-order (Morton order) inside a tile
+		//so the texels around a sample are close in memory whatever the direction of the uv gradient
+		constexpr int tileSizeShift{ 3 };
+		constexpr int tileSize{ 1 << tileSizeShift };
+
+		int CalculateTilesPerRow(int width)
+		{
+			return (width + tileSize - 1) >> tileSizeShift;
+		}
+
+		size_t CalculateTiledSize(int width, int height)
+		{
+			return static_cast<size_t>(CalculateTilesPerRow(width)) * CalculateTilesPerRow(height) * tileSize * tileSize;
+		}
+
+		size_t CalculateTiledIndex(int x, int y, int tilesPerRow)
+		{
+			//spreads the 3 bits of a coordinate to every other bit, x ends up in the even and y in the odd bits
+			constexpr uint32_t spreadBits[tileSize]{ 0b000000, 0b000001, 0b000100, 0b000101, 0b010000, 0b010001, 0b010100, 0b010101 };
+
+			const size_t tileIndex{ static_cast<size_t>(y >> tileSizeShift) * tilesPerRow + (x >> tileSizeShift) };
+			const uint32_t mortonIndex{ spreadBits[x & (tileSize - 1)] | spreadBits[y & (tileSize - 1)] << 1 };
+
+			return (tileIndex << (2 * tileSizeShift)) + mortonIndex;
+		}
+
+		//fetchTexel(x, y) returns the R8G8B8A8 texel at those coordinates of the mip level, it applies the address mode
+		//so the coordinates can be outside the level
+		template<typename TexelFetcher>
+		TexelColor SamplePoint(const TexelFetcher& fetchTexel, int width, int height, const Vector2& uv)
+		{
+			const int x{ static_cast<int>(std::floor(uv.x * width)) };
+			const int y{ static_cast<int>(std::floor(uv.y * height)) };
+
+			return LoadTexel(fetchTexel(x, y));
+		}
+
+		template<typename TexelFetcher>
+		TexelColor SampleBilinear(const TexelFetcher& fetchTexel, int width, int height, const Vector2& uv)
+		{
+			//texel centers are at half coordinates
+			const float x{ uv.x * width - 0.5f };
+			const float y{ uv.y * height - 0.5f };
+
+			const float floorX{ std::floor(x) };
+			const float floorY{ std::floor(y) };
+
+			const int x0{ static_cast<int>(floorX) };
+			const int y0{ static_cast<int>(floorY) };
+
+			const TexelColor top{ LerpTexelColor(LoadTexel(fetchTexel(x0, y0)), LoadTexel(fetchTexel(x0 + 1, y0)), x - floorX) };
+			const TexelColor bottom{ LerpTexelColor(LoadTexel(fetchTexel(x0, y0 + 1)), LoadTexel(fetchTexel(x0 + 1, y0 + 1)), x - floorX) };
+
+			return LerpTexelColor(top, bottom, y - floorY);
+		}
+
+		bool IsPowerOfTwo(int size)
+		{
+			return (size & (size - 1)) == 0;
+		}
+
+		//decoded blocks of the compressed textures, every thread has its own so there is nothing to synchronize
+		//the slot depends on the block coordinates, so the 4x4 blocks around a sample, the neighbouring mip levels
+		//and textures that are sampled at the same uv (diffuse, normal, ...) don't evict each other
+		struct DecodedBlockCache
+		{
+			static constexpr uint32_t m_AmountOfSlots{ 128 };
+
+			uint64_t keys[m_AmountOfSlots]{};
+			uint32_t texels[m_AmountOfSlots][BlockCompression::amountOfTexelsPerBlock]{};
+		};
+
+		thread_local DecodedBlockCache decodedBlockCache{};
+
+		std::atomic<uint32_t> nextTextureId{ 1 };
+
+		int CalculateBytesPerBlock(Texture::Format format)
+		{
+			switch (format)
+			{
+			case Texture::Format::bc1:
+				return BlockCompression::bc1BytesPerBlock;
+
+			case Texture::Format::bc3:
+				return BlockCompression::bc3BytesPerBlock;
+
+			case Texture::Format::bc5:
+				return BlockCompression::bc5BytesPerBlock;
+
+			default:
+				return 0;
+			}
+		}
+
+		int CalculateAmountOfBlocks(int size)
+		{
+			return (size + BlockCompression::blockSize - 1) / BlockCompression::blockSize;
+		}
+
+		DXGI_FORMAT GetDXGIFormat(Texture::Format format)
+		{
+			switch (format)
+			{
+			case Texture::Format::bc1:
+				return DXGI_FORMAT_BC1_UNORM;
+
+			case Texture::Format::bc3:
+				return DXGI_FORMAT_BC3_UNORM;
+
+			case Texture::Format::bc5:
+				return DXGI_FORMAT_BC5_UNORM;
+
+			default:
+				return DXGI_FORMAT_R8G8B8A8_UNORM;
+			}
+		}
+
+		template<typename Result>
+		bool IsReady(const std::future<Result>& future)
+		{
+			return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		//decoded textures are cached on disk, the hash of a file name covers the source images and the settings it was made with
+		//bump the version when the layout of the data or the encoders change
+		constexpr uint32_t cacheMagic{ 0x43584554 }; //"TEXC"
+		constexpr uint32_t cacheVersion{ 1 };
+
+		struct CacheHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t format;
+			int32_t width;
+			int32_t height;
+			uint32_t amountOfMipLevels;
+			uint64_t dataSize;
+		};
+
+		struct CachedMipLevel
+		{
+			int32_t width;
+			int32_t height;
+			uint64_t offset;
+		};
+
+		//the data starts aligned, so it can be used in place
+		size_t CalculateCacheDataOffset(size_t amountOfMipLevels)
+		{
+			constexpr size_t alignment{ 16 };
+			const size_t tableEnd{ sizeof(CacheHeader) + amountOfMipLevels * sizeof(CachedMipLevel) };
+			return (tableEnd + alignment - 1) / alignment * alignment;
+		}
+
+		//bytes of a level in the data of a cache file, the levels of uncompressed textures are stored in whole tiles
+		uint64_t CalculateCachedMipLevelSize(Texture::Format format, int width, int height)
+		{
+			if (format == Texture::Format::rgba8)
+				return sizeof(uint32_t) * static_cast<uint64_t>(CalculateTiledSize(width, height));
+
+			return static_cast<uint64_t>(CalculateBytesPerBlock(format)) * CalculateAmountOfBlocks(width) * CalculateAmountOfBlocks(height);
+		}
+
+		//the sampler and the uploads trust the mip table, so every level has to be half the size of the one above it,
+		//starting at the size of the texture, and has to lie within the data
+		bool IsCachedMipTableValid(const CacheHeader& header, const uint8_t* pMipTable)
+		{
+			const Texture::Format format{ static_cast<Texture::Format>(header.format) };
+			int width{ header.width };
+			int height{ header.height };
+
+			for (uint32_t level{}; level < header.amountOfMipLevels; ++level)
+			{
+				CachedMipLevel cachedMipLevel{};
+				std::memcpy(&cachedMipLevel, pMipTable + level * sizeof(CachedMipLevel), sizeof(cachedMipLevel));
+
+				if (cachedMipLevel.width != width || cachedMipLevel.height != height || cachedMipLevel.offset > header.dataSize)
+					return false;
+
+				//the offset of uncompressed levels counts texels, the one of compressed levels bytes
+				const uint64_t offset{ format == Texture::Format::rgba8 ? cachedMipLevel.offset * sizeof(uint32_t) : cachedMipLevel.offset };
+
+				if (offset + CalculateCachedMipLevelSize(format, width, height) > header.dataSize)
+					return false;
+
+				width = std::max(width / 2, 1);
+				height = std::max(height / 2, 1);
+			}
+
+			return true;
+		}
+
+		uint64_t HashTextureSettings(Texture::Format format, uint64_t hash)
+		{
+			hash = Utils::HashBytes(&cacheVersion, sizeof(cacheVersion), hash);
+			return Utils::HashBytes(&format, sizeof(format), hash);
+		}
+
+		//a packed texture depends on its images and on which of their channels end up where
+		uint64_t HashPackedSources(const std::array<Texture::ChannelSource, 4>& channelSources, const std::array<const MappedFile*, 4>& channelFiles, Texture::Format format)
+		{
+			uint64_t hash{ HashTextureSettings(format, Utils::HashBytes(nullptr, 0)) };
+
+			for (size_t channel{}; channel < channelSources.size(); ++channel)
+			{
+				hash = Utils::HashBytes(channelFiles[channel]->GetData(), channelFiles[channel]->GetSize(), hash);
+				hash = Utils::HashBytes(&channelSources[channel].channel, sizeof(channelSources[channel].channel), hash);
+			}
+
+			return hash;
+		}
+
+		SDL_Surface* LoadSurface(const MappedFile& file)
+		{
+			return IMG_Load_RW(SDL_RWFromConstMem(file.GetData(), static_cast<int>(file.GetSize())), 1);
+		}
+	}
+
+	Texture::Texture(SDL_Surface* pSurface, ID3D11Device* pDevice, Format format, const std::string& cachePath)
+		: m_Width{ pSurface->w }
+		, m_Height{ pSurface->h }
+		, m_Format{ format }
+		, m_Id{ nextTextureId++ }
+		, m_CachePath{ cachePath }
+	{
+		//convert once to a known layout, so sampling doesn't have to go through the surface format
+		SDL_Surface* pConvertedSurface{ SDL_ConvertSurfaceFormat(pSurface, SDL_PIXELFORMAT_RGBA32, 0) };
+		SDL_FreeSurface(pSurface);
+
+		m_Texels.resize(static_cast<size_t>(m_Width) * m_Height);
+
+		for (int row{}; row < m_Height; ++row)
+		{
+			std::memcpy(&m_Texels[static_cast<size_t>(row) * m_Width], static_cast<const uint8_t*>(pConvertedSurface->pixels) + row * pConvertedSurface->pitch, sizeof(uint32_t) * m_Width);
+		}
+
+		SDL_FreeSurface(pConvertedSurface);
+
+		GenerateMipLevels();
+
+		//D3D needs the top level of compressed textures to be a whole amount of blocks
+		if (m_Format != Format::rgba8 && (m_Width % BlockCompression::blockSize != 0 || m_Height % BlockCompression::blockSize != 0))
+		{
+			std::cout << "Texture size is not a multiple of " << BlockCompression::blockSize << ", it is kept uncompressed\n";
+			m_Format = Format::rgba8;
+		}
+
+		//D3D gets the rows from ConvertToLinearLayout, the software sampler reads the tiles (the blocks of compressed textures already are small tiles)
+		LayOutMipLevels();
+
+		m_pTexels = m_Texels.data();
+		m_pBlocks = m_Blocks.data();
+
+		m_MostDetailedResidentMip = CalculateInitialResidentMip();
+
+		//only the levels that start on the GPU are cooked before the texture can be used, UpdateResidency cooks the others on the asset loader
+		const int mostDetailedCookedMip{ pDevice ? m_MostDetailedResidentMip : 0 };
+
+		for (int mip{ static_cast<int>(m_MipLevels.size()) - 1 }; mip >= mostDetailedCookedMip; --mip)
+		{
+			CookMipLevel(mip);
+		}
+
+		m_MostDetailedCookedMip = mostDetailedCookedMip;
+		m_MostDetailedSampledMip = mostDetailedCookedMip;
+
+		if (mostDetailedCookedMip == 0)
+			SaveCookedTexture();
+		else
+			m_IsCooking = true;
+
+		if (pDevice)
+			CreateDirectXResources(pDevice);
+
+		SetAddressMode(Sampler::AddressMode::wrap);
+	}
+
+	Texture::Texture(MappedFile* pCacheFile, ID3D11Device* pDevice)
+		: m_Id{ nextTextureId++ }
+		, m_pCacheFile{ pCacheFile }
+	{
+		CacheHeader header{};
+		std::memcpy(&header, pCacheFile->GetData(), sizeof(header));
+
+		m_Width = header.width;
+		m_Height = header.height;
+		m_Format = static_cast<Format>(header.format);
+
+		for (uint32_t level{}; level < header.amountOfMipLevels; ++level)
+		{
+			CachedMipLevel cachedMipLevel{};
+			std::memcpy(&cachedMipLevel, pCacheFile->GetData() + sizeof(CacheHeader) + level * sizeof(CachedMipLevel), sizeof(cachedMipLevel));
+
+			m_MipLevels.push_back({ cachedMipLevel.width, cachedMipLevel.height, static_cast<size_t>(cachedMipLevel.offset), static_cast<int>(level) });
+		}
+
+		//the software sampler reads straight from the mapped file
+		const uint8_t* pData{ pCacheFile->GetData() + CalculateCacheDataOffset(m_MipLevels.size()) };
+
+		if (m_Format == Format::rgba8)
+			m_pTexels = reinterpret_cast<const uint32_t*>(pData);
+		else
+			m_pBlocks = pData;
+
+		m_MostDetailedResidentMip = CalculateInitialResidentMip();
+
+		if (pDevice)
+			CreateDirectXResources(pDevice);
+
+		SetAddressMode(Sampler::AddressMode::wrap);
+	}
+
+	void Texture::CreateDirectXResources(ID3D11Device* pDevice)
+	{
+		//only the resident levels exist on the GPU, the most detailed one is the top of the resource
+		const size_t amountOfResidentMipLevels{ m_MipLevels.size() - m_MostDetailedResidentMip };
+
+		std::vector<D3D11_SUBRESOURCE_DATA> initData(amountOfResidentMipLevels);
+		std::vector<std::vector<uint32_t>> linearTexels(m_Format == Format::rgba8 ? amountOfResidentMipLevels : 0);
+
+		for (size_t level{}; level < amountOfResidentMipLevels; ++level)
+		{
+			const MipLevel& mipLevel{ m_MipLevels[m_MostDetailedResidentMip + level] };
+
+			if (m_Format == Format::rgba8)
+			{
+				linearTexels[level] = ConvertToLinearLayout(mipLevel);
+				initData[level].pSysMem = linearTexels[level].data();
+			}
+			else
+			{
+				initData[level].pSysMem = m_pBlocks + mipLevel.offset;
+			}
+
+			initData[level].SysMemPitch = CalculateRowPitch(mipLevel);
+		}
+
+		SetResource(pDevice, CreateResource(pDevice, m_MostDetailedResidentMip, initData.data()), m_MostDetailedResidentMip);
+	}
+
+	ID3D11Texture2D* Texture::CreateResource(ID3D11Device* pDevice, int mostDetailedMip, const D3D11_SUBRESOURCE_DATA* pInitialData) const
 	{
-		DXGI_FORMAT format{ DXGI_FORMAT_R8G8B8A8_UNORM };
+		const MipLevel& mostDetailedMipLevel{ m_MipLevels[mostDetailedMip] };
+
 		D3D11_TEXTURE2D_DESC desc{};
-		desc.Width = pSurface->w;
-		desc.Height = pSurface->h;
-		desc.MipLevels = 1;
+		desc.Width = mostDetailedMipLevel.width;
+		desc.Height = mostDetailedMipLevel.height;
+		desc.MipLevels = static_cast<UINT>(m_MipLevels.size() - mostDetailedMip);
 		desc.ArraySize = 1;
-		desc.Format = format;
+		desc.Format = GetDXGIFormat(m_Format);
 		desc.SampleDesc.Count = 1;
 		desc.SampleDesc.Quality = 0;
 		desc.Usage = D3D11_USAGE_DEFAULT;
@@ -23,58 +433,831 @@ namespace dae
 		desc.CPUAccessFlags = 0;
 		desc.MiscFlags = 0;
 
-		D3D11_SUBRESOURCE_DATA initData;
-		initData.pSysMem = pSurface->pixels;
-		initData.SysMemPitch = static_cast<UINT>(pSurface->pitch);
-		initData.SysMemSlicePitch = static_cast<UINT>(pSurface->h * pSurface->pitch);
-
-		HRESULT result{ pDevice->CreateTexture2D(&desc, &initData, &m_pResource) };
+		ID3D11Texture2D* pResource{};
+		const HRESULT result{ pDevice->CreateTexture2D(&desc, pInitialData, &pResource) };
 
 		if (FAILED(result))
 			assert("Failed to create directX resource");
 
+		return pResource;
+	}
+
+	void Texture::SetResource(ID3D11Device* pDevice, ID3D11Texture2D* pResource, int mostDetailedMip)
+	{
 		D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc{};
-		SRVDesc.Format = format;
+		SRVDesc.Format = GetDXGIFormat(m_Format);
 		SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-		SRVDesc.Texture2D.MipLevels = 1;
+		SRVDesc.Texture2D.MipLevels = static_cast<UINT>(m_MipLevels.size() - mostDetailedMip);
 
-		result = pDevice->CreateShaderResourceView(m_pResource, &SRVDesc, &m_pSRV);
+		ID3D11ShaderResourceView* pSRV{};
+		const HRESULT result{ pDevice->CreateShaderResourceView(pResource, &SRVDesc, &pSRV) };
 
 		if (FAILED(result))
 			assert("Failed to create directX resource view");
+
+		//the effects hold their own reference to the old view until the texture is bound again
+		if (m_pSRV)
+			m_pSRV->Release();
+
+		if (m_pResource)
+			m_pResource->Release();
+
+		m_pResource = pResource;
+		m_pSRV = pSRV;
+		m_MostDetailedResidentMip = mostDetailedMip;
+	}
+
+	void Texture::ResizeResidentMipLevels(ID3D11Device* pDevice, ID3D11DeviceContext* pDeviceContext, int mostDetailedMip, const void* pNewMipLevel)
+	{
+		ID3D11Texture2D* pResource{ CreateResource(pDevice, mostDetailedMip, nullptr) };
+		const UINT amountOfMipLevels{ static_cast<UINT>(m_MipLevels.size() - mostDetailedMip) };
+		const UINT amountOfOldMipLevels{ static_cast<UINT>(m_MipLevels.size() - m_MostDetailedResidentMip) };
+
+		//the levels that stay resident are copied on the GPU, only a new level comes from the CPU
+		for (int mip{ std::max(mostDetailedMip, m_MostDetailedResidentMip) }; mip < static_cast<int>(m_MipLevels.size()); ++mip)
+		{
+			pDeviceContext->CopySubresourceRegion(pResource, D3D11CalcSubresource(mip - mostDetailedMip, 0, amountOfMipLevels), 0, 0, 0,
+				m_pResource, D3D11CalcSubresource(mip - m_MostDetailedResidentMip, 0, amountOfOldMipLevels), nullptr);
+		}
+
+		if (pNewMipLevel)
+			pDeviceContext->UpdateSubresource(pResource, D3D11CalcSubresource(0, 0, amountOfMipLevels), nullptr, pNewMipLevel, CalculateRowPitch(m_MipLevels[mostDetailedMip]), 0);
+
+		SetResource(pDevice, pResource, mostDetailedMip);
+	}
+
+	UINT Texture::CalculateRowPitch(const MipLevel& mipLevel) const
+	{
+		//a row of blocks for the compressed formats
+		if (m_Format == Format::rgba8)
+			return static_cast<UINT>(sizeof(uint32_t) * mipLevel.width);
+
+		return static_cast<UINT>(CalculateBytesPerBlock(m_Format) * CalculateAmountOfBlocks(mipLevel.width));
 	}
 
 	Texture::~Texture()
 	{
+		//the asset loader can still be working on this texture
+		if (m_CookJob.valid())
+			delete m_CookJob.get();
+
+		if (m_UploadJob.valid())
+			delete m_UploadJob.get();
+
 		if(m_pResource)
 			m_pResource->Release();
 
 		if(m_pSRV)
 			m_pSRV->Release();
 
-		if(m_pSurface)
-			SDL_FreeSurface(m_pSurface);
+		delete m_pCacheFile;
+	}
+
+	Texture* Texture::LoadFromFile(const std::string& path, ID3D11Device* pDevice, Format format)
+	{
+		MappedFile sourceFile{};
 
-		delete m_pRValue;
-		delete m_pGValue;
-		delete m_pBValue;
+		if (!sourceFile.Open(path))
+		{
+			std::cout << "Failed to open " << path << '\n';
+			return nullptr;
+		}
+
+		const std::string cachePath{ GetCachePath(sourceFile, format) };
+
+		if (Texture* pCachedTexture{ LoadFromCache(cachePath, pDevice) })
+			return pCachedTexture;
+
+		return new Texture(LoadSurface(sourceFile), pDevice, format, cachePath);
 	}
 
-	Texture* Texture::LoadFromFile(const std::string& path, ID3D11Device* pDevice)
+	Texture* Texture::LoadPackedFromFiles(const std::array<ChannelSource, 4>& channelSources, ID3D11Device* pDevice, Format format)
 	{
-		auto surface{ IMG_Load(path.c_str()) };
-		return new Texture(surface, pDevice);
+		//every image is opened once, even when it provides several channels
+		struct SourceImage
+		{
+			std::string path;
+			MappedFile file;
+			SDL_Surface* pSurface;
+		};
+
+		std::vector<std::unique_ptr<SourceImage>> sourceImages;
+		std::array<SourceImage*, 4> channelImages{};
+		std::array<const MappedFile*, 4> channelFiles{};
+
+		for (size_t channel{}; channel < channelSources.size(); ++channel)
+		{
+			const ChannelSource& channelSource{ channelSources[channel] };
+
+			auto sourceIt{ std::find_if(sourceImages.begin(), sourceImages.end(), [&](const auto& pSourceImage) { return pSourceImage->path == channelSource.path; }) };
+
+			if (sourceIt == sourceImages.end())
+			{
+				sourceImages.push_back(std::make_unique<SourceImage>());
+				sourceImages.back()->path = channelSource.path;
+
+				if (!sourceImages.back()->file.Open(channelSource.path))
+				{
+					std::cout << "Failed to open " << channelSource.path << '\n';
+					return nullptr;
+				}
+
+				sourceIt = sourceImages.end() - 1;
+			}
+
+			channelImages[channel] = sourceIt->get();
+			channelFiles[channel] = &channelImages[channel]->file;
+		}
+
+		const std::string cachePath{ Utils::GetCachePath(HashPackedSources(channelSources, channelFiles, format), ".texture") };
+
+		if (Texture* pCachedTexture{ LoadFromCache(cachePath, pDevice) })
+			return pCachedTexture;
+
+		for (const std::unique_ptr<SourceImage>& pSourceImage : sourceImages)
+		{
+			SDL_Surface* pLoadedSurface{ LoadSurface(pSourceImage->file) };
+			pSourceImage->pSurface = SDL_ConvertSurfaceFormat(pLoadedSurface, SDL_PIXELFORMAT_RGBA32, 0);
+			SDL_FreeSurface(pLoadedSurface);
+		}
+
+		SDL_Surface* pPackedSurface{};
+
+		for (int channel{}; channel < static_cast<int>(channelSources.size()); ++channel)
+		{
+			const ChannelSource& channelSource{ channelSources[channel] };
+			const SDL_Surface* pSourceSurface{ channelImages[channel]->pSurface };
+
+			if (!pPackedSurface)
+				pPackedSurface = SDL_CreateRGBSurfaceWithFormat(0, pSourceSurface->w, pSourceSurface->h, 32, SDL_PIXELFORMAT_RGBA32);
+
+			if (pSourceSurface->w != pPackedSurface->w || pSourceSurface->h != pPackedSurface->h)
+			{
+				std::cout << channelSource.path << " has a different size than the other channels, channel " << channel << " stays empty\n";
+				continue;
+			}
+
+			//RGBA32 stores the channels as bytes in RGBA order
+			for (int y{}; y < pPackedSurface->h; ++y)
+			{
+				const uint8_t* pSourceRow{ static_cast<const uint8_t*>(pSourceSurface->pixels) + y * pSourceSurface->pitch };
+				uint8_t* pPackedRow{ static_cast<uint8_t*>(pPackedSurface->pixels) + y * pPackedSurface->pitch };
+
+				for (int x{}; x < pPackedSurface->w; ++x)
+				{
+					pPackedRow[4 * x + channel] = pSourceRow[4 * x + channelSource.channel];
+				}
+			}
+		}
+
+		for (const std::unique_ptr<SourceImage>& pSourceImage : sourceImages)
+		{
+			SDL_FreeSurface(pSourceImage->pSurface);
+		}
+
+		return new Texture(pPackedSurface, pDevice, format, cachePath);
+	}
+
+	std::string Texture::GetCachePath(const std::string& path, Format format)
+	{
+		MappedFile sourceFile{};
+
+		if (!sourceFile.Open(path))
+			return {};
+
+		return GetCachePath(sourceFile, format);
 	}
 
-	ColorRGBA Texture::Sample(const Vector2& uv)
+	std::string Texture::GetPackedCachePath(const std::array<ChannelSource, 4>& channelSources, Format format)
 	{
-		const Vector2 scaledUV{ std::clamp(uv.x, 0.f, 1.f) * m_pSurface->w, std::clamp(uv.y, 0.f, 1.f) * m_pSurface->h };
+		std::array<MappedFile, 4> sourceFiles{};
+		std::array<const MappedFile*, 4> channelFiles{};
+
+		for (size_t channel{}; channel < channelSources.size(); ++channel)
+		{
+			if (!sourceFiles[channel].Open(channelSources[channel].path))
+				return {};
+
+			channelFiles[channel] = &sourceFiles[channel];
+		}
+
+		return Utils::GetCachePath(HashPackedSources(channelSources, channelFiles, format), ".texture");
+	}
+
+	std::string Texture::GetCachePath(const MappedFile& sourceFile, Format format)
+	{
+		return Utils::GetCachePath(HashTextureSettings(format, Utils::HashBytes(sourceFile.GetData(), sourceFile.GetSize())), ".texture");
+	}
+
+	Texture* Texture::LoadFromCache(const std::string& cachePath, ID3D11Device* pDevice)
+	{
+		MappedFile* pCacheFile{ new MappedFile() };
+
+		if (!pCacheFile->Open(cachePath) || pCacheFile->GetSize() < sizeof(CacheHeader))
+		{
+			delete pCacheFile;
+			return nullptr;
+		}
+
+		CacheHeader header{};
+		std::memcpy(&header, pCacheFile->GetData(), sizeof(header));
+
+		//a cache file that is cut off or was written by another version is made again
+		const bool isValid
+		{
+			header.magic == cacheMagic
+			&& header.version == cacheVersion
+			&& header.format <= static_cast<uint32_t>(Format::bc5)
+			&& header.width > 0 && header.width <= D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION
+			&& header.height > 0 && header.height <= D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION
+			&& header.amountOfMipLevels > 0 && header.amountOfMipLevels <= 32
+			&& header.dataSize <= pCacheFile->GetSize()
+			&& pCacheFile->GetSize() - header.dataSize >= CalculateCacheDataOffset(header.amountOfMipLevels)
+			&& IsCachedMipTableValid(header, pCacheFile->GetData() + sizeof(CacheHeader))
+		};
+
+		if (!isValid)
+		{
+			delete pCacheFile;
+			return nullptr;
+		}
+
+		return new Texture(pCacheFile, pDevice);
+	}
+
+	void Texture::SaveToCache(const std::string& cachePath) const
+	{
+		const uint8_t* pData{ m_Format == Format::rgba8 ? reinterpret_cast<const uint8_t*>(m_Texels.data()) : m_Blocks.data() };
+		const size_t dataSize{ m_Format == Format::rgba8 ? m_Texels.size() * sizeof(uint32_t) : m_Blocks.size() };
+
+		const CacheHeader header{ cacheMagic, cacheVersion, static_cast<uint32_t>(m_Format), m_Width, m_Height, static_cast<uint32_t>(m_MipLevels.size()), dataSize };
+
+		Utils::WriteCacheFile(cachePath, [&](std::ofstream& file)
+		{
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+			for (const MipLevel& mipLevel : m_MipLevels)
+			{
+				const CachedMipLevel cachedMipLevel{ mipLevel.width, mipLevel.height, mipLevel.offset };
+				file.write(reinterpret_cast<const char*>(&cachedMipLevel), sizeof(cachedMipLevel));
+			}
+
+			const std::vector<char> padding(CalculateCacheDataOffset(m_MipLevels.size()) - sizeof(CacheHeader) - m_MipLevels.size() * sizeof(CachedMipLevel));
+			file.write(padding.data(), padding.size());
+			file.write(reinterpret_cast<const char*>(pData), dataSize);
+		});
+	}
+
+	ColorRGBA Texture::Sample(const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, Sampler::SamplerStateKind filter) const
+	{
+		return (this->*m_pSampleFunction)(uv, uvDdx, uvDdy, filter);
+	}
+
+	void Texture::SetAddressMode(Sampler::AddressMode addressMode)
+	{
+		//the mip levels of a power of two texture are powers of two as well, down to 1x1
+		const bool isPowerOfTwo{ IsPowerOfTwo(m_Width) && IsPowerOfTwo(m_Height) };
+		TexelAddressing addressing{};
+
+		switch (addressMode)
+		{
+		case Sampler::AddressMode::wrap:
+			addressing = isPowerOfTwo ? TexelAddressing::wrapPowerOfTwo : TexelAddressing::wrap;
+			break;
+
+		case Sampler::AddressMode::clamp:
+			addressing = TexelAddressing::clamp;
+			break;
+
+		case Sampler::AddressMode::mirror:
+			addressing = isPowerOfTwo ? TexelAddressing::mirrorPowerOfTwo : TexelAddressing::mirror;
+			break;
+		}
+
+		//pick the texel fetch and addressing once, so they can be inlined in the filters
+		switch (m_Format)
+		{
+		case Format::rgba8:
+			m_pSampleFunction = SelectSampleFunction<Format::rgba8>(addressing);
+			break;
+
+		case Format::bc1:
+			m_pSampleFunction = SelectSampleFunction<Format::bc1>(addressing);
+			break;
+
+		case Format::bc3:
+			m_pSampleFunction = SelectSampleFunction<Format::bc3>(addressing);
+			break;
+
+		case Format::bc5:
+			m_pSampleFunction = SelectSampleFunction<Format::bc5>(addressing);
+			break;
+		}
+	}
+
+	template<Texture::Format format>
+	Texture::SampleFunction Texture::SelectSampleFunction(TexelAddressing addressing)
+	{
+		switch (addressing)
+		{
+		case TexelAddressing::wrapPowerOfTwo:
+			return &Texture::SampleFormat<format, TexelAddressing::wrapPowerOfTwo>;
+
+		case TexelAddressing::wrap:
+			return &Texture::SampleFormat<format, TexelAddressing::wrap>;
+
+		case TexelAddressing::clamp:
+			return &Texture::SampleFormat<format, TexelAddressing::clamp>;
+
+		case TexelAddressing::mirrorPowerOfTwo:
+			return &Texture::SampleFormat<format, TexelAddressing::mirrorPowerOfTwo>;
+
+		case TexelAddressing::mirror:
+			return &Texture::SampleFormat<format, TexelAddressing::mirror>;
+		}
+
+		return nullptr;
+	}
+
+	template<Texture::TexelAddressing addressing>
+	int Texture::AddressCoordinate(int coordinate, int size)
+	{
+		if constexpr (addressing == TexelAddressing::wrapPowerOfTwo)
+		{
+			//two's complement makes this work for negative coordinates as well
+			return coordinate & (size - 1);
+		}
+		else if constexpr (addressing == TexelAddressing::wrap)
+		{
+			const int wrapped{ coordinate % size };
+			return wrapped < 0 ? wrapped + size : wrapped;
+		}
+		else if constexpr (addressing == TexelAddressing::clamp)
+		{
+			return std::clamp(coordinate, 0, size - 1);
+		}
+		else if constexpr (addressing == TexelAddressing::mirrorPowerOfTwo)
+		{
+			//every second period is flipped, 2 * size - 1 has all bits of the period set
+			const int period{ coordinate & (2 * size - 1) };
+			return period & size ? period ^ (2 * size - 1) : period;
+		}
+		else
+		{
+			int period{ coordinate % (2 * size) };
+			period = period < 0 ? period + 2 * size : period;
+			return period < size ? period : 2 * size - 1 - period;
+		}
+	}
+
+	template<Texture::Format format>
+	uint32_t Texture::FetchTexel(const MipLevel& mipLevel, int x, int y) const
+	{
+		if constexpr (format == Format::rgba8)
+		{
+			return m_pTexels[mipLevel.offset + CalculateTiledIndex(x, y, CalculateTilesPerRow(mipLevel.width))];
+		}
+		else
+		{
+			constexpr int blockSize{ BlockCompression::blockSize };
+			const int blockX{ x / blockSize };
+			const int blockY{ y / blockSize };
+			const size_t blockOffset{ mipLevel.offset + (static_cast<size_t>(blockY) * CalculateAmountOfBlocks(mipLevel.width) + blockX) * CalculateBytesPerBlock(format) };
+
+			//the offset is unique within the texture, the id between textures, 0 is never a valid key
+			const uint64_t key{ static_cast<uint64_t>(m_Id) << 40 | blockOffset };
+			const uint32_t slot{ static_cast<uint32_t>((blockX & 3) | (blockY & 3) << 2 | (mipLevel.index & 1) << 4 | (m_Id & 3) << 5) };
+
+			DecodedBlockCache& cache{ decodedBlockCache };
+
+			if (cache.keys[slot] != key)
+			{
+				if constexpr (format == Format::bc1)
+					BlockCompression::DecodeBC1(m_pBlocks + blockOffset, cache.texels[slot]);
+				else if constexpr (format == Format::bc3)
+					BlockCompression::DecodeBC3(m_pBlocks + blockOffset, cache.texels[slot]);
+				else
+					BlockCompression::DecodeBC5(m_pBlocks + blockOffset, cache.texels[slot]);
+
+				cache.keys[slot] = key;
+			}
+
+			return cache.texels[slot][(y % blockSize) * blockSize + x % blockSize];
+		}
+	}
+
+	template<Texture::Format format, Texture::TexelAddressing addressing>
+	ColorRGBA Texture::SampleFormat(const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, Sampler::SamplerStateKind filter) const
+	{
+		//squared lengths of the pixel footprint in texels, max turns NaN into 0
+		const Vector2 texelDdx{ uvDdx.x * m_Width, uvDdx.y * m_Height };
+		const Vector2 texelDdy{ uvDdy.x * m_Width, uvDdy.y * m_Height };
+		const float ddxLengthSquared{ std::max(0.f, Vector2::Dot(texelDdx, texelDdx)) };
+		const float ddyLengthSquared{ std::max(0.f, Vector2::Dot(texelDdy, texelDdy)) };
+
+		//the level where the footprint is about one texel, but never one that isn't cooked yet
+		const auto calculateMipLevel = [this](float footprintSquared)
+		{
+			return std::clamp(0.5f * std::log2(std::max(1.f, footprintSquared)), static_cast<float>(m_MostDetailedSampledMip), static_cast<float>(m_MipLevels.size() - 1));
+		};
+
+		const auto fetchAddressedTexel = [this](const MipLevel& level, int x, int y)
+		{
+			return FetchTexel<format>(level, AddressCoordinate<addressing>(x, level.width), AddressCoordinate<addressing>(y, level.height));
+		};
+
+		const auto sampleMipLevel = [&](int mipLevel, const Vector2& uv)
+		{
+			const MipLevel& level{ m_MipLevels[mipLevel] };
+			return SampleBilinear([&](int x, int y) { return fetchAddressedTexel(level, x, y); }, level.width, level.height, uv);
+		};
+
+		const auto sampleTrilinear = [&](float mipLevel, const Vector2& uv)
+		{
+			const int lowerMipLevel{ static_cast<int>(mipLevel) };
+			const float blendFactor{ mipLevel - lowerMipLevel };
+			const TexelColor lowerColor{ sampleMipLevel(lowerMipLevel, uv) };
+
+			if (blendFactor == 0.f)
+				return lowerColor;
+
+			return LerpTexelColor(lowerColor, sampleMipLevel(lowerMipLevel + 1, uv), blendFactor);
+		};
+
+		switch (filter)
+		{
+		case Sampler::SamplerStateKind::point:
+		{
+			const MipLevel& level{ m_MipLevels[static_cast<int>(calculateMipLevel(std::max(ddxLengthSquared, ddyLengthSquared)) + 0.5f)] };
+			return ToColorRGBA(SamplePoint([&](int x, int y) { return fetchAddressedTexel(level, x, y); }, level.width, level.height, uv), 1.f);
+		}
+
+		case Sampler::SamplerStateKind::linear:
+			return ToColorRGBA(sampleTrilinear(calculateMipLevel(std::max(ddxLengthSquared, ddyLengthSquared)), uv), 1.f);
+
+		case Sampler::SamplerStateKind::anisotropic:
+		{
+			//several trilinear taps along the long axis of the footprint, each one only as blurry as the short axis
+			const bool isDdxMajor{ ddxLengthSquared >= ddyLengthSquared };
+			const float majorLengthSquared{ isDdxMajor ? ddxLengthSquared : ddyLengthSquared };
+			const float minorLengthSquared{ isDdxMajor ? ddyLengthSquared : ddxLengthSquared };
+			const Vector2& majorAxis{ isDdxMajor ? uvDdx : uvDdy };
+
+			const float anisotropy{ std::sqrt(majorLengthSquared / std::max(minorLengthSquared, FLT_MIN)) };
+			const int amountOfTaps{ anisotropy < Sampler::m_MaxAnisotropy ? std::max(static_cast<int>(std::ceil(anisotropy)), 1) : Sampler::m_MaxAnisotropy };
+			const float mipLevel{ calculateMipLevel(majorLengthSquared / (amountOfTaps * amountOfTaps)) };
+
+			TexelColor sum{ sampleTrilinear(mipLevel, uv + majorAxis * (0.5f / amountOfTaps - 0.5f)) };
+
+			for (int tap{ 1 }; tap < amountOfTaps; ++tap)
+			{
+				sum = AddTexelColor(sum, sampleTrilinear(mipLevel, uv + majorAxis * ((tap + 0.5f) / amountOfTaps - 0.5f)));
+			}
+
+			return ToColorRGBA(sum, 1.f / amountOfTaps);
+		}
+		}
+
+		return {};
+	}
+
+	void Texture::GenerateMipLevels()
+	{
+		m_MipLevels.push_back({ m_Width, m_Height, 0, 0 });
+
+		while (m_MipLevels.back().width > 1 || m_MipLevels.back().height > 1)
+		{
+			const MipLevel source{ m_MipLevels.back() };
+			const MipLevel destination{ std::max(source.width / 2, 1), std::max(source.height / 2, 1), m_Texels.size(), source.index + 1 };
+
+			m_Texels.resize(destination.offset + static_cast<size_t>(destination.width) * destination.height);
+
+			//box filter: every texel is the average of the 2x2 texels it covers in the level above
+			for (int y{}; y < destination.height; ++y)
+			{
+				const size_t sourceRow0{ source.offset + static_cast<size_t>(std::min(2 * y, source.height - 1)) * source.width };
+				const size_t sourceRow1{ source.offset + static_cast<size_t>(std::min(2 * y + 1, source.height - 1)) * source.width };
+
+				for (int x{}; x < destination.width; ++x)
+				{
+					const int sourceX0{ std::min(2 * x, source.width - 1) };
+					const int sourceX1{ std::min(2 * x + 1, source.width - 1) };
+
+					const uint32_t texels[4]
+					{
+						m_Texels[sourceRow0 + sourceX0],
+						m_Texels[sourceRow0 + sourceX1],
+						m_Texels[sourceRow1 + sourceX0],
+						m_Texels[sourceRow1 + sourceX1]
+					};
+
+					uint32_t averagedTexel{};
+
+					for (int shift{}; shift < 32; shift += 8)
+					{
+						uint32_t sum{ 2 }; //rounds to the nearest value instead of down
+
+						for (const uint32_t texel : texels)
+						{
+							sum += texel >> shift & 0xFF;
+						}
+
+						averagedTexel |= (sum / 4) << shift;
+					}
+
+					m_Texels[destination.offset + static_cast<size_t>(y) * destination.width + x] = averagedTexel;
+				}
+			}
+
+			m_MipLevels.push_back(destination);
+		}
+	}
+
+	void Texture::LayOutMipLevels()
+	{
+		//the linear mip chain is what the levels are cooked from
+		m_SourceTexels = std::move(m_Texels);
+		m_Texels = {};
+
+		size_t size{};
+
+		for (MipLevel& mipLevel : m_MipLevels)
+		{
+			m_SourceMipOffsets.push_back(mipLevel.offset);
+			mipLevel.offset = size;
+
+			//the tiles on the right and bottom edge are padded when the size isn't a multiple of the tile size
+			size += m_Format == Format::rgba8 ? CalculateTiledSize(mipLevel.width, mipLevel.height) : CalculateMipLevelSize(mipLevel);
+		}
+
+		//the room of every level is there from the start, so cooking a level never moves the ones the sampler reads
+		if (m_Format == Format::rgba8)
+			m_Texels.resize(size);
+		else
+			m_Blocks.resize(size);
+	}
+
+	void Texture::CookMipLevel(int mip)
+	{
+		const uint32_t* pSourceTexels{ m_SourceTexels.data() + m_SourceMipOffsets[mip] };
+
+		if (m_Format == Format::rgba8)
+			TileMipLevel(m_MipLevels[mip], pSourceTexels);
+		else
+			CompressMipLevel(m_MipLevels[mip], pSourceTexels);
+	}
+
+	MappedFile* Texture::CookRemainingMipLevels()
+	{
+		for (int mip{ m_MostDetailedCookedMip - 1 }; mip >= 0; --mip)
+		{
+			CookMipLevel(mip);
+			m_MostDetailedCookedMip = mip;
+		}
+
+		SaveCookedTexture();
+
+		MappedFile* pCacheFile{ new MappedFile() };
+		const size_t dataSize{ m_Format == Format::rgba8 ? m_Texels.size() * sizeof(uint32_t) : m_Blocks.size() };
+
+		if (m_CachePath.empty() || !pCacheFile->Open(m_CachePath) || pCacheFile->GetSize() != CalculateCacheDataOffset(m_MipLevels.size()) + dataSize)
+		{
+			delete pCacheFile;
+			return nullptr;
+		}
+
+		return pCacheFile;
+	}
+
+	void Texture::SaveCookedTexture()
+	{
+		if (!m_CachePath.empty())
+			SaveToCache(m_CachePath);
+
+		m_SourceTexels = {};
+		m_SourceMipOffsets = {};
+	}
+
+	void Texture::AdoptCacheFile(MappedFile* pCacheFile)
+	{
+		m_IsCooking = false;
+
+		//the cooked copy stays when the cache file couldn't be written
+		if (!pCacheFile)
+			return;
+
+		//the OS only keeps the pages of the cache file that are read, the cooked copy is all in memory
+		const uint8_t* pData{ pCacheFile->GetData() + CalculateCacheDataOffset(m_MipLevels.size()) };
+
+		if (m_Format == Format::rgba8)
+			m_pTexels = reinterpret_cast<const uint32_t*>(pData);
+		else
+			m_pBlocks = pData;
+
+		m_pCacheFile = pCacheFile;
+		m_Texels = {};
+		m_Blocks = {};
+	}
+
+	void Texture::TileMipLevel(const MipLevel& mipLevel, const uint32_t* pLinearTexels)
+	{
+		const int tilesPerRow{ CalculateTilesPerRow(mipLevel.width) };
+
+		for (int y{}; y < mipLevel.height; ++y)
+		{
+			for (int x{}; x < mipLevel.width; ++x)
+			{
+				m_Texels[mipLevel.offset + CalculateTiledIndex(x, y, tilesPerRow)] = pLinearTexels[static_cast<size_t>(y) * mipLevel.width + x];
+			}
+		}
+	}
+
+	void Texture::CompressMipLevel(const MipLevel& mipLevel, const uint32_t* pLinearTexels)
+	{
+		const int bytesPerBlock{ CalculateBytesPerBlock(m_Format) };
+		const int amountOfBlocksX{ CalculateAmountOfBlocks(mipLevel.width) };
+		const int amountOfBlocksY{ CalculateAmountOfBlocks(mipLevel.height) };
+
+		for (int blockY{}; blockY < amountOfBlocksY; ++blockY)
+		{
+			for (int blockX{}; blockX < amountOfBlocksX; ++blockX)
+			{
+				//levels smaller than a block repeat their last row and column
+				uint32_t blockTexels[BlockCompression::amountOfTexelsPerBlock]{};
+
+				for (int texelY{}; texelY < BlockCompression::blockSize; ++texelY)
+				{
+					for (int texelX{}; texelX < BlockCompression::blockSize; ++texelX)
+					{
+						const int x{ std::min(blockX * BlockCompression::blockSize + texelX, mipLevel.width - 1) };
+						const int y{ std::min(blockY * BlockCompression::blockSize + texelY, mipLevel.height - 1) };
+
+						blockTexels[texelY * BlockCompression::blockSize + texelX] = pLinearTexels[static_cast<size_t>(y) * mipLevel.width + x];
+					}
+				}
+
+				uint8_t* pBlock{ &m_Blocks[mipLevel.offset + (static_cast<size_t>(blockY) * amountOfBlocksX + blockX) * bytesPerBlock] };
+
+				switch (m_Format)
+				{
+				case Format::bc1:
+					BlockCompression::EncodeBC1(blockTexels, pBlock);
+					break;
+
+				case Format::bc3:
+					BlockCompression::EncodeBC3(blockTexels, pBlock);
+					break;
+
+				case Format::bc5:
+					BlockCompression::EncodeBC5(blockTexels, pBlock);
+					break;
+
+				default:
+					break;
+				}
+			}
+		}
+	}
+
+	std::vector<uint32_t> Texture::ConvertToLinearLayout(const MipLevel& mipLevel) const
+	{
+		std::vector<uint32_t> linearTexels(static_cast<size_t>(mipLevel.width) * mipLevel.height);
+		const int tilesPerRow{ CalculateTilesPerRow(mipLevel.width) };
+
+		for (int y{}; y < mipLevel.height; ++y)
+		{
+			for (int x{}; x < mipLevel.width; ++x)
+			{
+				linearTexels[static_cast<size_t>(y) * mipLevel.width + x] = m_pTexels[mipLevel.offset + CalculateTiledIndex(x, y, tilesPerRow)];
+			}
+		}
+
+		return linearTexels;
+	}
+
+	size_t Texture::CalculateMipLevelSize(const MipLevel& mipLevel) const
+	{
+		if (m_Format == Format::rgba8)
+			return sizeof(uint32_t) * mipLevel.width * mipLevel.height;
+
+		return static_cast<size_t>(CalculateBytesPerBlock(m_Format)) * CalculateAmountOfBlocks(mipLevel.width) * CalculateAmountOfBlocks(mipLevel.height);
+	}
+
+	bool Texture::CanBeMostDetailedMip(int mip) const
+	{
+		//D3D needs the top level of compressed textures to be a whole amount of blocks
+		if (m_Format == Format::rgba8 || mip == 0)
+			return true;
+
+		return m_MipLevels[mip].width % BlockCompression::blockSize == 0 && m_MipLevels[mip].height % BlockCompression::blockSize == 0;
+	}
+
+	int Texture::CalculateInitialResidentMip() const
+	{
+		int mip{};
+
+		while (mip < static_cast<int>(m_MipLevels.size()) - 1 && std::max(m_MipLevels[mip].width, m_MipLevels[mip].height) > m_InitialResidentSize && CanBeMostDetailedMip(mip + 1))
+		{
+			++mip;
+		}
+
+		return mip;
+	}
+
+	int Texture::CalculateWantedResidentMip(float screenSize) const
+	{
+		//the level where one texel covers about one pixel, a level more detailed because the uv islands of an atlas are smaller than the whole mesh
+		constexpr int extraDetailLevels{ 1 };
+		const int lastMip{ static_cast<int>(m_MipLevels.size()) - 1 };
+
+		int mip{ std::clamp(static_cast<int>(std::log2(std::max(m_Width, m_Height) / std::max(screenSize, 1.f))) - extraDetailLevels, 0, lastMip) };
+
+		//drop detail until the resident levels fit the budget
+		size_t residentSize{};
+
+		for (int level{ mip }; level <= lastMip; ++level)
+		{
+			residentSize += CalculateMipLevelSize(m_MipLevels[level]);
+		}
+
+		while (mip < lastMip && residentSize > m_MemoryBudget && CanBeMostDetailedMip(mip + 1))
+		{
+			residentSize -= CalculateMipLevelSize(m_MipLevels[mip]);
+			++mip;
+		}
+
+		while (!CanBeMostDetailedMip(mip))
+		{
+			--mip;
+		}
+
+		return mip;
+	}
+
+	size_t Texture::GetResidentMemory() const
+	{
+		size_t residentSize{};
+
+		for (size_t level{ static_cast<size_t>(m_MostDetailedResidentMip) }; level < m_MipLevels.size(); ++level)
+		{
+			residentSize += CalculateMipLevelSize(m_MipLevels[level]);
+		}
+
+		return residentSize;
+	}
+
+	bool Texture::UpdateResidency(ID3D11Device* pDevice, ID3D11DeviceContext* pDeviceContext, AssetLoader& assetLoader, float screenSize)
+	{
+		//the detailed levels are cooked on the asset loader, the cache file replaces the cooked copy once they are all done
+		if (m_IsCooking)
+		{
+			if (!m_CookJob.valid())
+				m_CookJob = assetLoader.Load<MappedFile>([this] { return CookRemainingMipLevels(); });
+			else if (IsReady(m_CookJob) && !m_UploadJob.valid())
+				AdoptCacheFile(m_CookJob.get());
+		}
+
+		m_MostDetailedSampledMip = m_MostDetailedCookedMip;
+
+		const int wantedMip{ CalculateWantedResidentMip(screenSize) };
+		bool hasChanged{};
+
+		if (IsReady(m_UploadJob))
+		{
+			const std::unique_ptr<StreamedMipLevel> pMipLevel{ m_UploadJob.get() };
+
+			//the level is dropped when less detail became enough while it was being prepared
+			if (pMipLevel->mip == m_MostDetailedResidentMip - 1 && wantedMip <= pMipLevel->mip)
+			{
+				ResizeResidentMipLevels(pDevice, pDeviceContext, pMipLevel->mip, pMipLevel->linearTexels.data());
+				hasChanged = true;
+			}
+		}
+
+		//less detail is evicted at once to free the memory
+		if (wantedMip > m_MostDetailedResidentMip)
+		{
+			ResizeResidentMipLevels(pDevice, pDeviceContext, wantedMip, nullptr);
+			return true;
+		}
+
+		if (hasChanged || wantedMip == m_MostDetailedResidentMip || m_UploadJob.valid())
+			return hasChanged;
+
+		//more detail comes in one level per call, only that level is uploaded
+		const int nextMip{ m_MostDetailedResidentMip - 1 };
 
-		Uint32 pixel{ m_pSurfacePixels[static_cast<int>(scaledUV.y) * m_pSurface->h + static_cast<int>(scaledUV.x)] };
+		if (nextMip < m_MostDetailedCookedMip)
+			return false;
 
-		Uint8 rValue{}, gValue{}, bValue{}, alphaValue{};
-		SDL_GetRGBA(pixel, m_pSurface->format, &rValue, &gValue, &bValue, &alphaValue);
+		//blocks are uploaded as they are, the tiles of uncompressed levels are put back in rows on the asset loader
+		if (m_Format != Format::rgba8)
+		{
+			ResizeResidentMipLevels(pDevice, pDeviceContext, nextMip, m_pBlocks + m_MipLevels[nextMip].offset);
+			return true;
+		}
 
-		return { rValue / 255.f, gValue / 255.f, bValue / 255.f, alphaValue / 255.f };
+		m_UploadJob = assetLoader.Load<StreamedMipLevel>([this, nextMip] { return new StreamedMipLevel{ nextMip, ConvertToLinearLayout(m_MipLevels[nextMip]) }; });
+		return false;
 	}
-}
\ No newline at end of file
+}
@@ -1,30 +1,178 @@
 #pragma once
 #include "pch.h"
 #include <string>
+#include <array>
+#include <atomic>
+#include <future>
 #include "ColorRGB.h"
+#include "Sampler.h"
 
 namespace dae
 {
 	struct Vector2;
+	class MappedFile;
+	class AssetLoader;
 
 	class Texture
 	{
 	public:
+		//how the texels are stored, both in memory and on the GPU
+		enum class Format
+		{
+			rgba8,
+			bc1, //RGB, 4 bits per texel
+			bc3, //RGBA, 8 bits per texel
+			bc5 //RG, 8 bits per texel, for normal maps (z is reconstructed in the shader)
+		};
+
+		//channel of a source image that ends up in a channel of a packed texture
+		struct ChannelSource
+		{
+			std::string path;
+			int channel; //0 = red, 1 = green, 2 = blue, 3 = alpha
+		};
+
 		~Texture();
 
-		static Texture* LoadFromFile(const std::string& path, ID3D11Device* pDevice);
-		ColorRGBA Sample(const Vector2& uv);
+		//compressed formats are encoded at load, the result is cached on disk and mapped on the next runs
+		//without a cache file only the small mip levels are made here, the others are cooked on the asset loader by UpdateResidency
+		//pDevice can be nullptr, then there is no resource for the hardware path and every level is cooked and cached right away (used to cook the cache file)
+		static Texture* LoadFromFile(const std::string& path, ID3D11Device* pDevice, Format format = Format::rgba8);
+		//combines one channel of (possibly) different images per channel, so a shader can read them with one sample
+		//all source images need to have the same size
+		static Texture* LoadPackedFromFiles(const std::array<ChannelSource, 4>& channelSources, ID3D11Device* pDevice, Format format = Format::rgba8);
+		//the files the textures are cached in, named after the source images and the format, empty when an image can't be opened
+		static std::string GetCachePath(const std::string& path, Format format = Format::rgba8);
+		static std::string GetPackedCachePath(const std::array<ChannelSource, 4>& channelSources, Format format = Format::rgba8);
+		//the mip level is picked from the change in uv to the next pixel in x and y, the filter works like the D3D sampler state of that kind
+		ColorRGBA Sample(const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, Sampler::SamplerStateKind filter) const;
+		//call this when the texture is bound with a sampler, Sample uses it from then on (wrap by default, like the D3D samplers)
+		void SetAddressMode(Sampler::AddressMode addressMode);
 		ID3D11ShaderResourceView* GetSRV() const { return m_pSRV; }
+		int GetWidth() const { return m_Width; }
+		int GetHeight() const { return m_Height; }
+		Format GetFormat() const { return m_Format; }
+
+		//textures start with the levels up to this size on the GPU, the more detailed ones are streamed in by UpdateResidency
+		static constexpr int m_InitialResidentSize{ 64 };
+		//screenSize is the amount of pixels the texture covers on screen along its longest side,
+		//uploads one more detailed level when it's needed or evicts the levels that aren't, the levels that stay are copied on the GPU
+		//the levels are cooked and converted for the upload on the asset loader, this never waits for them
+		//returns true when the SRV changed, the texture has to be bound again then
+		bool UpdateResidency(ID3D11Device* pDevice, ID3D11DeviceContext* pDeviceContext, AssetLoader& assetLoader, float screenSize);
+		//true while the asset loader still works on a level of this texture
+		bool IsStreaming() const { return m_IsCooking || m_UploadJob.valid(); }
+		//the levels on the GPU never take more than this, the most detailed ones are left out when they would
+		//the software sampler reads the CPU copy, that is the mapped cache file once the texture is cooked, so it isn't limited
+		void SetMemoryBudget(size_t memoryBudget) { m_MemoryBudget = memoryBudget; }
+		size_t GetResidentMemory() const;
+		int GetMostDetailedResidentMip() const { return m_MostDetailedResidentMip; }
 
 	private:
-		Texture(SDL_Surface* pSurface, ID3D11Device* pDevice);
+		struct MipLevel
+		{
+			int width;
+			int height;
+			size_t offset; //first texel of the level in m_Texels, or first byte in m_Blocks for compressed formats
+			int index;
+		};
+
+		//the address modes that Sample can use, power of two sizes can wrap and mirror with a bitmask
+		enum class TexelAddressing
+		{
+			wrapPowerOfTwo,
+			wrap,
+			clamp,
+			mirrorPowerOfTwo,
+			mirror
+		};
+
+		//a level that was converted to rows on the asset loader, ready to be uploaded
+		struct StreamedMipLevel
+		{
+			int mip;
+			std::vector<uint32_t> linearTexels;
+		};
+
+		using SampleFunction = ColorRGBA(Texture::*)(const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, Sampler::SamplerStateKind filter) const;
+
+		Texture(SDL_Surface* pSurface, ID3D11Device* pDevice, Format format, const std::string& cachePath);
+		Texture(MappedFile* pCacheFile, ID3D11Device* pDevice);
+
+		int m_Width{};
+		int m_Height{};
+		Format m_Format{};
+		const uint32_t m_Id;
+		//R8G8B8A8 with red in the lowest byte (same layout as DXGI_FORMAT_R8G8B8A8_UNORM), in 8x8 tiles with Z-order inside a tile
+		//all mip levels are stored after each other, starting with the full resolution one
+		std::vector<uint32_t> m_Texels;
+		//the blocks of all mip levels of compressed formats, in rows like D3D stores them
+		std::vector<uint8_t> m_Blocks;
+		std::vector<MipLevel> m_MipLevels;
+		//the data the sampler reads: the vectors above, or the cache file when the texture was loaded from it
+		const uint32_t* m_pTexels{};
+		const uint8_t* m_pBlocks{};
+		MappedFile* m_pCacheFile{};
+
+		//only the levels from this one on are on the GPU
+		int m_MostDetailedResidentMip{};
+		size_t m_MemoryBudget{ SIZE_MAX };
+
+		//a texture that wasn't cached yet is cooked from its linear mip chain, the levels from m_MostDetailedCookedMip on are done
+		//the software sampler uses m_MostDetailedSampledMip, that only changes between frames
+		std::vector<uint32_t> m_SourceTexels;
+		std::vector<size_t> m_SourceMipOffsets;
+		std::string m_CachePath;
+		bool m_IsCooking{};
+		std::atomic<int> m_MostDetailedCookedMip{};
+		int m_MostDetailedSampledMip{};
+		//the cook job returns the cache file it wrote, the CPU copy moves to it
+		std::future<MappedFile*> m_CookJob;
+		std::future<StreamedMipLevel*> m_UploadJob;
+
+		//SampleFormat for the format and address mode of the texture
+		SampleFunction m_pSampleFunction{};
 
-		SDL_Surface* m_pSurface{ nullptr };
-		uint32_t* m_pSurfacePixels{ nullptr };
 		ID3D11ShaderResourceView* m_pSRV{}; // = shader resource view
 		ID3D11Texture2D* m_pResource{};
-		
-		//pixel color to pass to the SDL_GetRGB fucntion
-		Uint8 *m_pRValue{ new Uint8() }, *m_pGValue{ new Uint8() }, *m_pBValue{ new Uint8() };
+
+		template<Format format, TexelAddressing addressing>
+		ColorRGBA SampleFormat(const Vector2& uv, const Vector2& uvDdx, const Vector2& uvDdy, Sampler::SamplerStateKind filter) const;
+		template<Format format>
+		static SampleFunction SelectSampleFunction(TexelAddressing addressing);
+		template<TexelAddressing addressing>
+		static int AddressCoordinate(int coordinate, int size);
+		template<Format format>
+		uint32_t FetchTexel(const MipLevel& mipLevel, int x, int y) const;
+
+		static std::string GetCachePath(const MappedFile& sourceFile, Format format);
+		static Texture* LoadFromCache(const std::string& cachePath, ID3D11Device* pDevice);
+		void SaveToCache(const std::string& cachePath) const;
+		//creates the resource with the resident mip levels
+		void CreateDirectXResources(ID3D11Device* pDevice);
+		//a texture with the levels from mostDetailedMip on, in a default resource so levels can be copied and uploaded into it
+		ID3D11Texture2D* CreateResource(ID3D11Device* pDevice, int mostDetailedMip, const D3D11_SUBRESOURCE_DATA* pInitialData) const;
+		//makes pResource the resident levels, releases the old resource and view
+		void SetResource(ID3D11Device* pDevice, ID3D11Texture2D* pResource, int mostDetailedMip);
+		//pNewMipLevel is the data of mostDetailedMip when that level wasn't resident yet, in the layout D3D wants
+		void ResizeResidentMipLevels(ID3D11Device* pDevice, ID3D11DeviceContext* pDeviceContext, int mostDetailedMip, const void* pNewMipLevel);
+		UINT CalculateRowPitch(const MipLevel& mipLevel) const;
+		size_t CalculateMipLevelSize(const MipLevel& mipLevel) const;
+		bool CanBeMostDetailedMip(int mip) const;
+		int CalculateInitialResidentMip() const;
+		int CalculateWantedResidentMip(float screenSize) const;
+
+		void GenerateMipLevels();
+		//moves the linear mip chain to m_SourceTexels and makes room for the levels in the layout of the format
+		void LayOutMipLevels();
+		void CookMipLevel(int mip);
+		//runs on the asset loader, cooks the levels that weren't cooked yet and caches the texture
+		MappedFile* CookRemainingMipLevels();
+		void SaveCookedTexture();
+		//the sampler reads from the cache file from then on, the cooked copy is freed
+		void AdoptCacheFile(MappedFile* pCacheFile);
+		void TileMipLevel(const MipLevel& mipLevel, const uint32_t* pLinearTexels);
+		std::vector<uint32_t> ConvertToLinearLayout(const MipLevel& mipLevel) const;
+		void CompressMipLevel(const MipLevel& mipLevel, const uint32_t* pLinearTexels);
 	};
 }
\ No newline at end of file
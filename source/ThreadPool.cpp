@@ -0,0 +1,178 @@
+#include "pch.h"
+#include "ThreadPool.h"
+#include <numeric>
+
+namespace dae
+{
+	ThreadPool::ThreadPool(uint32_t amountOfThreads)
+		: m_AmountOfThreads{ std::max(amountOfThreads, 1u) }
+		, m_JobQueues(m_AmountOfThreads)
+		, m_BusyTicks(m_AmountOfThreads)
+	{
+		//the thread that calls ParallelFor is worker 0, so only the others have to be created
+		for (uint32_t workerIndex{ 1 }; workerIndex < m_AmountOfThreads; ++workerIndex)
+		{
+			m_Workers.emplace_back(&ThreadPool::WorkerLoop, this, workerIndex);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock{ m_Mutex };
+			m_IsShuttingDown = true;
+		}
+
+		m_WorkAvailableCondition.notify_all();
+
+		for (std::thread& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	void ThreadPool::ParallelFor(uint32_t amountOfJobs, const std::function<void(uint32_t jobIndex)>& job)
+	{
+		m_DefaultJobOrder.resize(amountOfJobs);
+		std::iota(m_DefaultJobOrder.begin(), m_DefaultJobOrder.end(), 0u);
+
+		ParallelFor(m_DefaultJobOrder, job);
+	}
+
+	void ThreadPool::ParallelFor(const std::vector<uint32_t>& jobOrder, const std::function<void(uint32_t jobIndex)>& job)
+	{
+		const uint64_t startTicks{ SDL_GetPerformanceCounter() };
+
+		if (m_Workers.empty() || jobOrder.size() <= 1)
+		{
+			for (const uint32_t jobIndex : jobOrder)
+			{
+				job(jobIndex);
+			}
+
+			const uint64_t elapsedTicks{ SDL_GetPerformanceCounter() - startTicks };
+			m_BusyTicks[0] += elapsedTicks;
+			m_ParallelForTicks += elapsedTicks;
+			return;
+		}
+
+		{
+			std::lock_guard lock{ m_Mutex };
+
+			//deal the jobs out like cards, so every worker starts with one of the most expensive ones
+			for (JobQueue& jobQueue : m_JobQueues)
+			{
+				jobQueue.jobIndices.clear();
+				jobQueue.front = 0;
+			}
+
+			for (size_t index{}; index < jobOrder.size(); ++index)
+			{
+				m_JobQueues[index % m_AmountOfThreads].jobIndices.push_back(jobOrder[index]);
+			}
+
+			for (JobQueue& jobQueue : m_JobQueues)
+			{
+				jobQueue.back = jobQueue.jobIndices.size();
+			}
+
+			m_pJob = &job;
+			m_AmountOfBusyWorkers = static_cast<uint32_t>(m_Workers.size());
+			++m_Generation;
+		}
+
+		m_WorkAvailableCondition.notify_all();
+
+		RunJobs(0);
+
+		std::unique_lock lock{ m_Mutex };
+		m_WorkDoneCondition.wait(lock, [this] { return m_AmountOfBusyWorkers == 0; });
+		m_pJob = nullptr;
+
+		m_ParallelForTicks += SDL_GetPerformanceCounter() - startTicks;
+	}
+
+	float ThreadPool::GetUtilization(uint32_t workerIndex) const
+	{
+		if (m_ParallelForTicks == 0)
+			return 0.f;
+
+		return static_cast<float>(m_BusyTicks[workerIndex]) / m_ParallelForTicks;
+	}
+
+	void ThreadPool::ResetUtilization()
+	{
+		std::fill(m_BusyTicks.begin(), m_BusyTicks.end(), 0ull);
+		m_ParallelForTicks = 0;
+	}
+
+	void ThreadPool::WorkerLoop(uint32_t workerIndex)
+	{
+		uint64_t handledGeneration{};
+
+		while (true)
+		{
+			{
+				std::unique_lock lock{ m_Mutex };
+				m_WorkAvailableCondition.wait(lock, [&] { return m_IsShuttingDown || m_Generation != handledGeneration; });
+
+				if (m_IsShuttingDown)
+					return;
+
+				handledGeneration = m_Generation;
+			}
+
+			RunJobs(workerIndex);
+
+			{
+				std::lock_guard lock{ m_Mutex };
+				--m_AmountOfBusyWorkers;
+			}
+
+			m_WorkDoneCondition.notify_one();
+		}
+	}
+
+	void ThreadPool::RunJobs(uint32_t workerIndex)
+	{
+		const uint64_t startTicks{ SDL_GetPerformanceCounter() };
+		uint32_t jobIndex{};
+
+		while (PopJob(workerIndex, jobIndex) || StealJob(workerIndex, jobIndex))
+		{
+			(*m_pJob)(jobIndex);
+		}
+
+		m_BusyTicks[workerIndex] += SDL_GetPerformanceCounter() - startTicks;
+	}
+
+	bool ThreadPool::PopJob(uint32_t workerIndex, uint32_t& jobIndex)
+	{
+		JobQueue& jobQueue{ m_JobQueues[workerIndex] };
+		std::lock_guard lock{ jobQueue.mutex };
+
+		if (jobQueue.front == jobQueue.back)
+			return false;
+
+		jobIndex = jobQueue.jobIndices[jobQueue.front++];
+		return true;
+	}
+
+	bool ThreadPool::StealJob(uint32_t workerIndex, uint32_t& jobIndex)
+	{
+		for (uint32_t offset{ 1 }; offset < m_AmountOfThreads; ++offset)
+		{
+			JobQueue& jobQueue{ m_JobQueues[(workerIndex + offset) % m_AmountOfThreads] };
+			std::lock_guard lock{ jobQueue.mutex };
+
+			if (jobQueue.front == jobQueue.back)
+				continue;
+
+			//take from the back, those are the cheapest jobs of that worker
+			jobIndex = jobQueue.jobIndices[--jobQueue.back];
+			return true;
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
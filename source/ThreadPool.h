@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace dae
+{
+	class ThreadPool final
+	{
+	public:
+		ThreadPool(uint32_t amountOfThreads = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool& other) = delete;
+		ThreadPool(ThreadPool&& other) = delete;
+		ThreadPool& operator=(const ThreadPool& other) = delete;
+		ThreadPool& operator=(ThreadPool&& other) = delete;
+
+		//calls job(jobIndex) for every jobIndex in [0, amountOfJobs) and returns when all of them are done
+		//the calling thread works along, jobs are not allowed to call ParallelFor themselves
+		void ParallelFor(uint32_t amountOfJobs, const std::function<void(uint32_t jobIndex)>& job);
+		//same as above but for the job indices in jobOrder, sort them from most to least expensive:
+		//the jobs are dealt out over the workers in that order and a worker that runs out steals the cheapest jobs of the others
+		void ParallelFor(const std::vector<uint32_t>& jobOrder, const std::function<void(uint32_t jobIndex)>& job);
+
+		uint32_t GetAmountOfThreads() const { return m_AmountOfThreads; }
+		//fraction of the time spent in ParallelFor that the worker was running jobs, since the last ResetUtilization
+		float GetUtilization(uint32_t workerIndex) const;
+		void ResetUtilization();
+
+	private:
+		struct JobQueue
+		{
+			std::mutex mutex;
+			std::vector<uint32_t> jobIndices;
+			size_t front{};
+			size_t back{};
+		};
+
+		const uint32_t m_AmountOfThreads;
+		std::vector<std::thread> m_Workers;
+		std::vector<JobQueue> m_JobQueues;
+		std::vector<uint32_t> m_DefaultJobOrder;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkAvailableCondition;
+		std::condition_variable m_WorkDoneCondition;
+
+		const std::function<void(uint32_t)>* m_pJob{ nullptr };
+		uint32_t m_AmountOfBusyWorkers{};
+		uint64_t m_Generation{};
+		bool m_IsShuttingDown{};
+
+		std::vector<uint64_t> m_BusyTicks;
+		uint64_t m_ParallelForTicks{};
+
+		void WorkerLoop(uint32_t workerIndex);
+		void RunJobs(uint32_t workerIndex);
+		bool PopJob(uint32_t workerIndex, uint32_t& jobIndex);
+		bool StealJob(uint32_t workerIndex, uint32_t& jobIndex);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace dae
+{
+	//lock-free hand-over of the latest state from one writer thread to one reader thread
+	//the writer always has a buffer to write in and the reader always reads the most recently published one
+	template<typename T>
+	class TripleBuffer final
+	{
+	public:
+		TripleBuffer() = default;
+		~TripleBuffer() = default;
+
+		TripleBuffer(const TripleBuffer& other) = delete;
+		TripleBuffer(TripleBuffer&& other) = delete;
+		TripleBuffer& operator=(const TripleBuffer& other) = delete;
+		TripleBuffer& operator=(TripleBuffer&& other) = delete;
+
+		//writer side
+		T& GetWriteBuffer() { return m_Buffers[m_WriteIndex]; }
+		void Publish()
+		{
+			m_WriteIndex = m_SharedState.exchange(m_WriteIndex | m_NewDataFlag, std::memory_order_acq_rel) & m_IndexMask;
+		}
+
+		//reader side, returns false if nothing was published since the last call
+		bool Consume()
+		{
+			if ((m_SharedState.load(std::memory_order_relaxed) & m_NewDataFlag) == 0)
+				return false;
+
+			m_ReadIndex = m_SharedState.exchange(m_ReadIndex, std::memory_order_acq_rel) & m_IndexMask;
+			return true;
+		}
+		const T& GetReadBuffer() const { return m_Buffers[m_ReadIndex]; }
+
+	private:
+		static constexpr uint8_t m_IndexMask{ 0b011 };
+		static constexpr uint8_t m_NewDataFlag{ 0b100 };
+
+		T m_Buffers[3]{};
+
+		//index of the buffer that is not owned by the writer or the reader, plus a flag if it holds unread data
+		std::atomic<uint8_t> m_SharedState{ 1 };
+		uint8_t m_WriteIndex{ 0 };
+		uint8_t m_ReadIndex{ 2 };
+	};
+}
\ No newline at end of file
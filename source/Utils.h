@@ -1,165 +1,802 @@
 #pragma once
-#include <fstream>
 #include "Math.h"
 #include "Mesh.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
 #include <vector>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <future>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 
 namespace dae
 {
 	namespace Utils
 	{
-		//Just parses vertices and indices
+		enum class OBJCommand
+		{
+			none,
+			position,
+			uv,
+			normal,
+			face
+		};
+
+		//amount of every element in a part of an obj file, or where its elements start in the arrays of the whole file
+		struct OBJCounts
+		{
+			size_t amountOfPositions;
+			size_t amountOfUVs;
+			size_t amountOfNormals;
+			size_t amountOfFaces;
+		};
+
+		struct OBJAttributes
+		{
+			std::vector<Vector3> positions;
+			std::vector<Vector2> UVs;
+			std::vector<Vector3> normals;
+		};
+
+		//one part of an obj file, every part is counted and parsed on its own thread
+		struct OBJChunk
+		{
+			const char* pBegin;
+			const char* pEnd;
+			OBJCounts counts;
+			OBJCounts offsets;
+		};
+
 #pragma warning(push)
 #pragma warning(disable : 4505) //Warning unreferenced local function
-		static bool ParseOBJ(const std::string& filename, std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
+		//FNV-1a, pass the previous result as hash to continue hashing over multiple buffers
+		static uint64_t HashBytes(const void* pData, size_t size, uint64_t hash = 14695981039346656037ull)
 		{
-			std::ifstream file(filename);
-			if (!file)
-				return false;
+			const uint8_t* pBytes{ static_cast<const uint8_t*>(pData) };
 
-			std::vector<Vector3> positions{};
-			std::vector<Vector3> normals{};
-			std::vector<Vector2> UVs{};
+			for (size_t index{}; index < size; ++index)
+			{
+				hash ^= pBytes[index];
+				hash *= 1099511628211ull;
+			}
 
-			vertices.clear();
-			indices.clear();
+			return hash;
+		}
+
+		//data that takes long to make (decoded textures, parsed meshes) is cached in files named after the hash of what they are made from,
+		//so changed sources get a new file and unchanged ones are mapped straight into memory
+		inline const std::string cacheDirectory{ "Cache/" };
+
+		static std::string GetCachePath(uint64_t hash, const std::string& extension)
+		{
+			std::stringstream cachePath{};
+			cachePath << cacheDirectory << std::hex << hash << extension;
+			return cachePath.str();
+		}
+
+		//write is called with the opened file, which only gets its name when it is complete,
+		//so a crash halfway never leaves a file that looks valid
+		static bool WriteCacheFile(const std::string& cachePath, const std::function<void(std::ofstream& file)>& write)
+		{
+			std::error_code error{};
+			std::filesystem::create_directories(cacheDirectory, error);
+
+			const std::string temporaryPath{ cachePath + ".tmp" };
+
+			{
+				std::ofstream file{ temporaryPath, std::ios::binary };
+
+				if (!file)
+				{
+					std::cout << "Failed to write cache file " << cachePath << '\n';
+					return false;
+				}
+
+				write(file);
+			}
+
+			std::filesystem::rename(temporaryPath, cachePath, error);
+			return !error;
+		}
+
+		//corners with the same position, uv and normal index are welded into one vertex
+		//open addressing on the index triples, the table is at most half full and doubles when it would get fuller
+		class OBJVertexWelder
+		{
+		public:
+			explicit OBJVertexWelder(size_t expectedAmountOfVertices)
+			{
+				Resize(expectedAmountOfVertices);
+				m_VertexSlots.reserve(expectedAmountOfVertices);
+			}
 
-			std::string sCommand;
-			// start a while iteration ending when the end of file is reached (ios::eof)
-			while (!file.eof())
+			//the vertex of the corner, a corner that wasn't seen before gets the next one
+			uint32_t Weld(const std::array<uint32_t, 3>& corner)
 			{
-				//read the first word of the string, use the >> operator (istream::operator>>) 
-				file >> sCommand;
-				//use conditional statements to process the different commands	
-				if (sCommand == "#")
+				const size_t slot{ FindSlot(corner) };
+
+				if (m_SlotVertices[slot] == m_EmptySlot)
 				{
-					// Ignore Comment
+					if (2 * (m_VertexSlots.size() + 1) > m_SlotVertices.size())
+					{
+						Resize(m_VertexSlots.size() + 1);
+						return Weld(corner);
+					}
+
+					m_SlotCorners[slot] = corner;
+					m_SlotVertices[slot] = static_cast<uint32_t>(m_VertexSlots.size());
+					m_VertexSlots.push_back(static_cast<uint32_t>(slot));
 				}
-				else if (sCommand == "v")
+
+				return m_SlotVertices[slot];
+			}
+
+			uint32_t GetAmountOfVertices() const { return static_cast<uint32_t>(m_VertexSlots.size()); }
+
+			//vertices gets exactly one element per welded vertex
+			void BuildVertices(const OBJAttributes& attributes, std::vector<Mesh::Vertex_In>& vertices) const
+			{
+				vertices.resize(m_VertexSlots.size());
+
+				for (size_t vertexIndex{}; vertexIndex < m_VertexSlots.size(); ++vertexIndex)
 				{
-					//Vertex
-					float x, y, z;
-					file >> x >> y >> z;
+					const std::array<uint32_t, 3>& corner{ m_SlotCorners[m_VertexSlots[vertexIndex]] };
+					Mesh::Vertex_In vertex{};
+					vertex.position = attributes.positions[corner[0] - 1];
+
+					if (corner[1] != 0)
+						vertex.uv = attributes.UVs[corner[1] - 1];
+
+					if (corner[2] != 0)
+						vertex.normal = attributes.normals[corner[2] - 1];
 
-					positions.emplace_back(x, y, z);
+					vertices[vertexIndex] = vertex;
 				}
-				else if (sCommand == "vt")
+			}
+
+			//only the used slots are emptied, so a small part doesn't pay for the whole table
+			void Clear()
+			{
+				for (const uint32_t slot : m_VertexSlots)
 				{
-					// Vertex TexCoord
-					float u, v;
-					file >> u >> v;
-					UVs.emplace_back(u, 1 - v);
+					m_SlotVertices[slot] = m_EmptySlot;
 				}
-				else if (sCommand == "vn")
+
+				m_VertexSlots.clear();
+			}
+
+		private:
+			static constexpr uint32_t m_EmptySlot{ UINT32_MAX };
+
+			//the slot that holds the corner, or the empty one where it goes
+			size_t FindSlot(const std::array<uint32_t, 3>& corner) const
+			{
+				const size_t slotMask{ m_SlotVertices.size() - 1 };
+				size_t slot{ HashBytes(corner.data(), sizeof(corner)) & slotMask };
+
+				while (m_SlotVertices[slot] != m_EmptySlot && m_SlotCorners[slot] != corner)
 				{
-					// Vertex Normal
-					float x, y, z;
-					file >> x >> y >> z;
-				
-					normals.emplace_back(x, y, z);
+					slot = (slot + 1) & slotMask;
 				}
-				else if (sCommand == "f")
+
+				return slot;
+			}
+
+			//makes room for amountOfVertices vertices and puts the welded ones in their new slots
+			void Resize(size_t amountOfVertices)
+			{
+				size_t amountOfSlots{ std::max(m_SlotVertices.size(), size_t{ 1 }) };
+
+				while (amountOfSlots < 2 * amountOfVertices)
 				{
-					//if a face is read:
-					//construct the 3 vertices, add them to the vertex array
-					//add three indices to the index array
-					//add the material index as attibute to the attribute array
-					//
-					// Faces or triangles
-					Mesh::Vertex_In vertex{};
-					size_t iPosition, iTexCoord, iNormal;
-				
-					uint32_t tempIndices[3];
-					for (size_t iFace = 0; iFace < 3; iFace++)
+					amountOfSlots *= 2;
+				}
+
+				std::vector<std::array<uint32_t, 3>> oldSlotCorners(amountOfSlots);
+				std::swap(oldSlotCorners, m_SlotCorners);
+				m_SlotVertices.assign(amountOfSlots, m_EmptySlot);
+
+				for (size_t vertexIndex{}; vertexIndex < m_VertexSlots.size(); ++vertexIndex)
+				{
+					const std::array<uint32_t, 3>& corner{ oldSlotCorners[m_VertexSlots[vertexIndex]] };
+					const size_t slot{ FindSlot(corner) };
+
+					m_SlotCorners[slot] = corner;
+					m_SlotVertices[slot] = static_cast<uint32_t>(vertexIndex);
+					m_VertexSlots[vertexIndex] = static_cast<uint32_t>(slot);
+				}
+			}
+
+			std::vector<std::array<uint32_t, 3>> m_SlotCorners;
+			std::vector<uint32_t> m_SlotVertices;
+			//the slot of every vertex, in the order they were welded
+			std::vector<uint32_t> m_VertexSlots;
+		};
+
+		//how many ranges of at least minimumRangeSize elements to split amountOfElements in, at most one per hardware thread
+		static size_t GetAmountOfRanges(size_t amountOfElements, size_t minimumRangeSize)
+		{
+			return std::clamp(amountOfElements / minimumRangeSize, size_t{ 1 }, static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)));
+		}
+
+		//processRange(rangeIndex, begin, end) is called for amountOfRanges equal parts of the elements,
+		//for the first one on this thread and for the others each on their own thread
+		template<typename ProcessRange>
+		static void ForEachRange(size_t amountOfElements, size_t amountOfRanges, const ProcessRange& processRange)
+		{
+			std::vector<std::future<void>> rangeProcessors;
+
+			for (size_t rangeIndex{ 1 }; rangeIndex < amountOfRanges; ++rangeIndex)
+			{
+				rangeProcessors.push_back(std::async(std::launch::async, [&, rangeIndex]
+				{
+					processRange(rangeIndex, amountOfElements * rangeIndex / amountOfRanges, amountOfElements * (rangeIndex + 1) / amountOfRanges);
+				}));
+			}
+
+			processRange(size_t{ 0 }, size_t{ 0 }, amountOfElements / amountOfRanges);
+
+			for (std::future<void>& rangeProcessor : rangeProcessors)
+			{
+				rangeProcessor.get();
+			}
+		}
+
+		//parseChunk is called for every chunk, for the first one on this thread and for the others each on their own thread
+		template<typename Chunks, typename ParseChunk>
+		static void ForEachOBJChunk(Chunks& chunks, const ParseChunk& parseChunk)
+		{
+			ForEachRange(chunks.size(), chunks.size(), [&](size_t chunkIndex, size_t, size_t) { parseChunk(chunks[chunkIndex]); });
+		}
+
+		static const char* SkipOBJSpaces(const char* pCharacter, const char* pEnd)
+		{
+			while (pCharacter < pEnd && (*pCharacter == ' ' || *pCharacter == '\t'))
+			{
+				++pCharacter;
+			}
+
+			return pCharacter;
+		}
+
+		static const char* ParseOBJFloat(const char* pCharacter, const char* pEnd, float& value)
+		{
+			pCharacter = SkipOBJSpaces(pCharacter, pEnd);
+
+			//from_chars doesn't take a plus sign
+			if (pCharacter < pEnd && *pCharacter == '+')
+				++pCharacter;
+
+			const std::from_chars_result result{ std::from_chars(pCharacter, pEnd, value) };
+
+			if (result.ec != std::errc{})
+				value = 0.f;
+
+			return result.ptr;
+		}
+
+		static const char* ParseOBJIndex(const char* pCharacter, const char* pEnd, uint32_t& index)
+		{
+			const std::from_chars_result result{ std::from_chars(pCharacter, pEnd, index) };
+
+			if (result.ec != std::errc{})
+				index = 0;
+
+			return result.ptr;
+		}
+
+		//the command at the start of a line, pCharacter is moved past it
+		static OBJCommand ParseOBJCommand(const char*& pCharacter, const char* pLineEnd)
+		{
+			pCharacter = SkipOBJSpaces(pCharacter, pLineEnd);
+
+			const auto isCommand = [&](const char* pCommand, size_t length)
+			{
+				return pCharacter + length < pLineEnd && std::memcmp(pCharacter, pCommand, length) == 0 && (pCharacter[length] == ' ' || pCharacter[length] == '\t');
+			};
+
+			if (isCommand("v", 1))
+			{
+				pCharacter += 1;
+				return OBJCommand::position;
+			}
+
+			if (isCommand("vt", 2))
+			{
+				pCharacter += 2;
+				return OBJCommand::uv;
+			}
+
+			if (isCommand("vn", 2))
+			{
+				pCharacter += 2;
+				return OBJCommand::normal;
+			}
+
+			if (isCommand("f", 1))
+			{
+				pCharacter += 1;
+				return OBJCommand::face;
+			}
+
+			return OBJCommand::none;
+		}
+
+		//only triangles, the corners after the third one are ignored
+		static void ParseOBJFace(const char* pCharacter, const char* pLineEnd, std::array<uint32_t, 3>* pCorners)
+		{
+			for (int corner{}; corner < 3; ++corner)
+			{
+				std::array<uint32_t, 3> indices{};
+				pCharacter = ParseOBJIndex(SkipOBJSpaces(pCharacter, pLineEnd), pLineEnd, indices[0]);
+
+				if (pCharacter < pLineEnd && *pCharacter == '/')
+				{
+					++pCharacter;
+
+					//optional texture coordinate
+					if (pCharacter < pLineEnd && *pCharacter != '/')
+						pCharacter = ParseOBJIndex(pCharacter, pLineEnd, indices[1]);
+
+					//optional vertex normal
+					if (pCharacter < pLineEnd && *pCharacter == '/')
+						pCharacter = ParseOBJIndex(pCharacter + 1, pLineEnd, indices[2]);
+				}
+
+				pCorners[corner] = indices;
+			}
+		}
+
+		//calls parseLine with the command and the rest of every line, pBegin has to be the start of a line, pEnd the end of one
+		template<typename ParseLine>
+		static void ForEachOBJLine(const char* pBegin, const char* pEnd, const ParseLine& parseLine)
+		{
+			const char* pLine{ pBegin };
+
+			while (pLine < pEnd)
+			{
+				const char* pLineEnd{ static_cast<const char*>(std::memchr(pLine, '\n', pEnd - pLine)) };
+				pLineEnd = pLineEnd ? pLineEnd : pEnd;
+
+				const char* pCharacter{ pLine };
+				const OBJCommand command{ ParseOBJCommand(pCharacter, pLineEnd) };
+
+				if (command != OBJCommand::none)
+					parseLine(command, pCharacter, pLineEnd);
+
+				pLine = pLineEnd + 1;
+			}
+		}
+
+		static void CountOBJChunk(OBJChunk& chunk)
+		{
+			chunk.counts = {};
+
+			ForEachOBJLine(chunk.pBegin, chunk.pEnd, [&](OBJCommand command, const char*, const char*)
+			{
+				switch (command)
+				{
+				case OBJCommand::position:
+					++chunk.counts.amountOfPositions;
+					break;
+				case OBJCommand::uv:
+					++chunk.counts.amountOfUVs;
+					break;
+				case OBJCommand::normal:
+					++chunk.counts.amountOfNormals;
+					break;
+				case OBJCommand::face:
+					++chunk.counts.amountOfFaces;
+					break;
+				default:
+					break;
+				}
+			});
+		}
+
+		//writes the attributes of the chunk into its ranges of the arrays that hold the whole file,
+		//the corners of its faces too when pCorners isn't null
+		static void ParseOBJChunk(const OBJChunk& chunk, OBJAttributes& attributes, std::array<uint32_t, 3>* pCorners)
+		{
+			OBJCounts offsets{ chunk.offsets };
+
+			ForEachOBJLine(chunk.pBegin, chunk.pEnd, [&](OBJCommand command, const char* pCharacter, const char* pLineEnd)
+			{
+				switch (command)
+				{
+				case OBJCommand::position:
+				{
+					Vector3& position{ attributes.positions[offsets.amountOfPositions++] };
+					pCharacter = ParseOBJFloat(pCharacter, pLineEnd, position.x);
+					pCharacter = ParseOBJFloat(pCharacter, pLineEnd, position.y);
+					ParseOBJFloat(pCharacter, pLineEnd, position.z);
+					break;
+				}
+				case OBJCommand::uv:
+				{
+					Vector2& uv{ attributes.UVs[offsets.amountOfUVs++] };
+					pCharacter = ParseOBJFloat(pCharacter, pLineEnd, uv.x);
+					ParseOBJFloat(pCharacter, pLineEnd, uv.y);
+					uv.y = 1 - uv.y;
+					break;
+				}
+				case OBJCommand::normal:
+				{
+					Vector3& normal{ attributes.normals[offsets.amountOfNormals++] };
+					pCharacter = ParseOBJFloat(pCharacter, pLineEnd, normal.x);
+					pCharacter = ParseOBJFloat(pCharacter, pLineEnd, normal.y);
+					ParseOBJFloat(pCharacter, pLineEnd, normal.z);
+					break;
+				}
+				case OBJCommand::face:
+					if (pCorners)
+						ParseOBJFace(pCharacter, pLineEnd, pCorners + offsets.amountOfFaces * 3);
+
+					++offsets.amountOfFaces;
+					break;
+				default:
+					break;
+				}
+			});
+		}
+
+		//splits the mapped file in parts that start at the beginning of a line, counts the elements of every part in parallel
+		//and allocates the attributes of the whole file with their exact size, so parsing them only writes
+		static std::vector<OBJChunk> PrepareOBJChunks(const MappedFile& file, OBJAttributes& attributes, OBJCounts& totalCounts)
+		{
+			const char* pFileBegin{ reinterpret_cast<const char*>(file.GetData()) };
+			const char* pFileEnd{ pFileBegin + file.GetSize() };
+
+			//small files aren't worth the threads
+			constexpr size_t minimumChunkSize{ 256 * 1024 };
+			const size_t amountOfChunks{ GetAmountOfRanges(file.GetSize(), minimumChunkSize) };
+
+			std::vector<OBJChunk> chunks(amountOfChunks);
+			chunks[0].pBegin = pFileBegin;
+
+			for (size_t chunkIndex{ 1 }; chunkIndex < amountOfChunks; ++chunkIndex)
+			{
+				const char* pSplit{ std::max(pFileBegin + file.GetSize() * chunkIndex / amountOfChunks, chunks[chunkIndex - 1].pBegin) };
+				const char* pLineEnd{ static_cast<const char*>(std::memchr(pSplit, '\n', pFileEnd - pSplit)) };
+
+				chunks[chunkIndex].pBegin = pLineEnd ? pLineEnd + 1 : pFileEnd;
+				chunks[chunkIndex - 1].pEnd = chunks[chunkIndex].pBegin;
+			}
+
+			chunks.back().pEnd = pFileEnd;
+
+			ForEachOBJChunk(chunks, [](OBJChunk& chunk) { CountOBJChunk(chunk); });
+
+			//the indices in the file count over the whole file, so the attributes of the chunks are put after each other
+			totalCounts = {};
+
+			for (OBJChunk& chunk : chunks)
+			{
+				chunk.offsets = totalCounts;
+				totalCounts.amountOfPositions += chunk.counts.amountOfPositions;
+				totalCounts.amountOfUVs += chunk.counts.amountOfUVs;
+				totalCounts.amountOfNormals += chunk.counts.amountOfNormals;
+				totalCounts.amountOfFaces += chunk.counts.amountOfFaces;
+			}
+
+			attributes.positions.resize(totalCounts.amountOfPositions);
+			attributes.UVs.resize(totalCounts.amountOfUVs);
+			attributes.normals.resize(totalCounts.amountOfNormals);
+
+			return chunks;
+		}
+
+		//a corner without uv or normal keeps the one of the corner before it
+		//false when the face uses an index that doesn't exist
+		static bool ResolveOBJFace(const std::array<uint32_t, 3>* pFileCorners, const OBJAttributes& attributes, std::array<uint32_t, 3> (&corners)[3])
+		{
+			std::array<uint32_t, 3> previousCorner{};
+
+			for (size_t corner{}; corner < 3; ++corner)
+			{
+				const std::array<uint32_t, 3>& fileIndices{ pFileCorners[corner] };
+
+				// OBJ format uses 1-based arrays
+				if (fileIndices[0] == 0 || fileIndices[0] > attributes.positions.size() || fileIndices[1] > attributes.UVs.size() || fileIndices[2] > attributes.normals.size())
+					return false;
+
+				corners[corner][0] = fileIndices[0];
+				corners[corner][1] = fileIndices[1] != 0 ? fileIndices[1] : previousCorner[1];
+				corners[corner][2] = fileIndices[2] != 0 ? fileIndices[2] : previousCorner[2];
+				previousCorner = corners[corner];
+			}
+
+			return true;
+		}
+
+		//tangent frames from the uv derivatives of the triangles around every vertex
+		//a vertex that is shared by triangles with mirrored and unmirrored uvs is split, so the two sides don't average out,
+		//tangentSign tells them apart, the binormal is tangentSign * cross(normal, tangent)
+		//the vertices are split in ranges, every thread sums the triangles around its own vertices
+		static void CalculateTangents(std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices)
+		{
+			const size_t amountOfTriangles{ indices.size() / 3 };
+
+			constexpr size_t minimumTrianglesPerRange{ 16 * 1024 };
+			const size_t amountOfTriangleRanges{ GetAmountOfRanges(amountOfTriangles, minimumTrianglesPerRange) };
+
+			//sign of the uv area of every triangle, 0 for a triangle without one, it has no tangent
+			std::vector<int8_t> triangleSigns(amountOfTriangles);
+
+			const auto calculateUVArea = [&](size_t triangle)
+			{
+				const Vector2& uv0{ vertices[indices[triangle * 3]].uv };
+				const Vector2& uv1{ vertices[indices[triangle * 3 + 1]].uv };
+				const Vector2& uv2{ vertices[indices[triangle * 3 + 2]].uv };
+
+				return Vector2::Cross({ uv1.x - uv0.x, uv2.x - uv0.x }, { uv1.y - uv0.y, uv2.y - uv0.y });
+			};
+
+			ForEachRange(amountOfTriangles, amountOfTriangleRanges, [&](size_t, size_t firstTriangle, size_t endTriangle)
+			{
+				for (size_t triangle{ firstTriangle }; triangle < endTriangle; ++triangle)
+				{
+					const float uvArea{ calculateUVArea(triangle) };
+					triangleSigns[triangle] = uvArea > 0.f ? 1 : (uvArea < 0.f ? -1 : 0);
+				}
+			});
+
+			//the mirrored triangles get their own copy of the vertices they share with unmirrored ones
+			constexpr uint8_t positiveSign{ 1 };
+			constexpr uint8_t negativeSign{ 2 };
+			std::vector<uint8_t> vertexSigns(vertices.size());
+
+			for (size_t index{}; index < indices.size(); ++index)
+			{
+				if (triangleSigns[index / 3] != 0)
+					vertexSigns[indices[index]] |= triangleSigns[index / 3] > 0 ? positiveSign : negativeSign;
+			}
+
+			const size_t amountOfSplitVertices{ static_cast<size_t>(std::count(vertexSigns.begin(), vertexSigns.end(), positiveSign | negativeSign)) };
+
+			if (amountOfSplitVertices > 0)
+			{
+				constexpr uint32_t notSplit{ UINT32_MAX };
+				std::vector<uint32_t> mirroredVertices(vertices.size(), notSplit);
+				vertices.reserve(vertices.size() + amountOfSplitVertices);
+
+				for (size_t index{}; index < indices.size(); ++index)
+				{
+					const uint32_t vertex{ indices[index] };
+
+					if (triangleSigns[index / 3] >= 0 || vertexSigns[vertex] != (positiveSign | negativeSign))
+						continue;
+
+					if (mirroredVertices[vertex] == notSplit)
 					{
-						// OBJ format uses 1-based arrays
-						file >> iPosition;
-						vertex.position = positions[iPosition - 1];
-				
-						if ('/' == file.peek())//is next in buffer ==  '/' ?
-						{
-							file.ignore();//read and ignore one element ('/')
-				
-							if ('/' != file.peek())
-							{
-								// Optional texture coordinate
-								file >> iTexCoord;
-								vertex.uv = UVs[iTexCoord - 1];
-							}
-				
-							if ('/' == file.peek())
-							{
-								file.ignore();
-				
-								// Optional vertex normal
-								file >> iNormal;
-								vertex.normal = normals[iNormal - 1];
-							}
-						}
-				
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
+						mirroredVertices[vertex] = static_cast<uint32_t>(vertices.size());
+						vertices.push_back(vertices[vertex]);
 					}
-				
-					indices.push_back(tempIndices[0]);
-					if (flipAxisAndWinding) 
+
+					indices[index] = mirroredVertices[vertex];
+				}
+			}
+
+			//tangent and bitangent point along u and v on the triangle, their length doesn't matter because they are summed
+			struct TangentFrame
+			{
+				Vector3 tangent;
+				Vector3 bitangent;
+			};
+
+			const auto calculateTriangleFrame = [&](size_t triangle)
+			{
+				const Mesh::Vertex_In& v0{ vertices[indices[triangle * 3]] };
+				const Mesh::Vertex_In& v1{ vertices[indices[triangle * 3 + 1]] };
+				const Mesh::Vertex_In& v2{ vertices[indices[triangle * 3 + 2]] };
+
+				const Vector3 edge0{ v1.position - v0.position };
+				const Vector3 edge1{ v2.position - v0.position };
+				const Vector2 diffX{ v1.uv.x - v0.uv.x, v2.uv.x - v0.uv.x };
+				const Vector2 diffY{ v1.uv.y - v0.uv.y, v2.uv.y - v0.uv.y };
+				const float r{ 1.f / Vector2::Cross(diffX, diffY) };
+
+				return TangentFrame{ (edge0 * diffY.y - edge1 * diffY.x) * r, (edge1 * diffX.x - edge0 * diffX.y) * r };
+			};
+
+			//every vertex sums the triangles around it, so a thread only writes its own vertices and nothing is allocated per thread
+			//a triangle is worked out once per corner, which is cheaper than keeping the frames of all triangles
+			const MeshOptimizer::VertexTriangles vertexTriangles{ MeshOptimizer::BuildVertexTriangles(indices, vertices.size()) };
+
+			constexpr size_t minimumVerticesPerRange{ 16 * 1024 };
+
+			ForEachRange(vertices.size(), GetAmountOfRanges(vertices.size(), minimumVerticesPerRange), [&](size_t, size_t firstVertex, size_t endVertex)
+			{
+				for (size_t vertexIndex{ firstVertex }; vertexIndex < endVertex; ++vertexIndex)
+				{
+					TangentFrame frame{};
+
+					for (uint32_t offset{ vertexTriangles.offsets[vertexIndex] }; offset < vertexTriangles.offsets[vertexIndex + 1]; ++offset)
 					{
-						indices.push_back(tempIndices[2]);
-						indices.push_back(tempIndices[1]);
+						const uint32_t triangle{ vertexTriangles.triangles[offset] };
+
+						if (triangleSigns[triangle] == 0)
+							continue;
+
+						const TangentFrame triangleFrame{ calculateTriangleFrame(triangle) };
+						frame.tangent += triangleFrame.tangent;
+						frame.bitangent += triangleFrame.bitangent;
 					}
-					else
+
+					Mesh::Vertex_In& vertex{ vertices[vertexIndex] };
+					Vector3 tangent{ frame.tangent };
+
+					if (vertex.normal.SqrMagnitude() > 0.f)
+						tangent = Vector3::Reject(tangent, vertex.normal);
+
+					//no uv area around the vertex, any direction along the surface will do
+					if (tangent.SqrMagnitude() == 0.f)
 					{
-						indices.push_back(tempIndices[1]);
-						indices.push_back(tempIndices[2]);
+						const Vector3 axis{ std::abs(vertex.normal.x) < 0.9f ? Vector3::UnitX : Vector3::UnitY };
+						tangent = vertex.normal.SqrMagnitude() > 0.f ? Vector3::Reject(axis, vertex.normal) : axis;
 					}
+
+					vertex.tangent = tangent.Normalized();
+					vertex.tangentSign = Vector3::Dot(Vector3::Cross(vertex.normal, vertex.tangent), frame.bitangent) < 0.f ? -1.f : 1.f;
 				}
-				//read till end of line and ignore all remaining chars
-				file.ignore(1000, '\n');
-			}
+			});
+		}
 
-			//Cheap Tangent Calculations
-			for (uint32_t i = 0; i < indices.size(); i += 3)
+		//calculates the tangents and converts from the right handed obj space to the left handed one of the renderer
+		static void FinishOBJVertices(std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+		{
+			CalculateTangents(vertices, indices);
+
+			if (!flipAxisAndWinding)
+				return;
+
+			//mirroring the z axis mirrors the tangent frame too
+			for (Mesh::Vertex_In& vertex : vertices)
 			{
-				uint32_t index0 = indices[i];
-				uint32_t index1 = indices[size_t(i) + 1];
-				uint32_t index2 = indices[size_t(i) + 2];
-			
-				const Vector3& p0 = vertices[index0].position;
-				const Vector3& p1 = vertices[index1].position;
-				const Vector3& p2 = vertices[index2].position;
-				const Vector2& uv0 = vertices[index0].uv;
-				const Vector2& uv1 = vertices[index1].uv;
-				const Vector2& uv2 = vertices[index2].uv;
-			
-				const Vector3 edge0 = p1 - p0;
-				const Vector3 edge1 = p2 - p0;
-				const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
-				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
-				float r = 1.f / Vector2::Cross(diffX, diffY);
-			
-				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
-				vertices[index0].tangent += tangent;
-				vertices[index1].tangent += tangent;
-				vertices[index2].tangent += tangent;
+				vertex.position.z *= -1.f;
+				vertex.normal.z *= -1.f;
+				vertex.tangent.z *= -1.f;
+				vertex.tangentSign *= -1.f;
 			}
+		}
+
+		//parses vertices and indices, the file is mapped in memory and split in parts that are parsed in parallel
+		//every distinct position, uv and normal combination becomes one vertex
+		//everything is counted first, so every array is allocated once with its exact size and written in place
+		static bool ParseOBJ(const std::string& filename, std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
+		{
+			vertices.clear();
+			indices.clear();
+
+			MappedFile file{};
+
+			if (!file.Open(filename))
+				return false;
+
+			OBJAttributes attributes{};
+			OBJCounts totalCounts{};
+			const std::vector<OBJChunk> chunks{ PrepareOBJChunks(file, attributes, totalCounts) };
+
+			const size_t amountOfCorners{ totalCounts.amountOfFaces * 3 };
 
-			//Create the Tangents (reject)
-			for (auto& v : vertices)
 			{
-				v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
-			
-				if(flipAxisAndWinding)
+				//position, uv and normal index of the 3 corners of every face, 1-based like in the file and 0 when it is missing
+				std::vector<std::array<uint32_t, 3>> fileCorners(amountOfCorners);
+
+				ForEachOBJChunk(chunks, [&](const OBJChunk& chunk) { ParseOBJChunk(chunk, attributes, fileCorners.data()); });
+
+				//usually every position is used by about one vertex, the welder grows when there are more
+				OBJVertexWelder welder{ std::max({ totalCounts.amountOfPositions, totalCounts.amountOfUVs, totalCounts.amountOfNormals }) };
+				indices.resize(amountOfCorners);
+
+				for (size_t cornerIndex{}; cornerIndex < amountOfCorners; cornerIndex += 3)
 				{
-					v.position.z *= -1.f;
-					v.normal.z *= -1.f;
-					v.tangent.z *= -1.f;
+					std::array<uint32_t, 3> corners[3]{};
+
+					if (!ResolveOBJFace(&fileCorners[cornerIndex], attributes, corners))
+					{
+						std::cout << filename << " has a face with an index that doesn't exist\n";
+						indices.clear();
+						return false;
+					}
+
+					const uint32_t faceIndices[3]{ welder.Weld(corners[0]), welder.Weld(corners[1]), welder.Weld(corners[2]) };
+
+					indices[cornerIndex] = faceIndices[0];
+					indices[cornerIndex + 1] = flipAxisAndWinding ? faceIndices[2] : faceIndices[1];
+					indices[cornerIndex + 2] = flipAxisAndWinding ? faceIndices[1] : faceIndices[2];
 				}
-			
+
+				welder.BuildVertices(attributes, vertices);
+			}
+
+			FinishOBJVertices(vertices, indices, flipAxisAndWinding);
+
+			return true;
+		}
+
+		//parses a model that may not fit in memory as a whole, as separate parts of at most maxVerticesPerPart welded vertices
+		//(and the copies that mirrored uvs need)
+		//only the attributes of the file and one part are in memory: every part is given to emitPart, which can move its vertices and indices away
+		//the faces stay in file order, a vertex on the border between two parts is in both and gets its tangent from the faces of each part
+		//at a face with an index that doesn't exist it stops and returns false, the parts before it were emitted already
+		static bool ParseOBJInParts(const std::string& filename, uint32_t maxVerticesPerPart,
+			const std::function<void(std::vector<Mesh::Vertex_In>& vertices, std::vector<uint32_t>& indices)>& emitPart, bool flipAxisAndWinding = true)
+		{
+			MappedFile file{};
+
+			if (!file.Open(filename) || maxVerticesPerPart < 3)
+				return false;
+
+			OBJAttributes attributes{};
+			OBJCounts totalCounts{};
+			const std::vector<OBJChunk> chunks{ PrepareOBJChunks(file, attributes, totalCounts) };
+
+			//the faces are not stored, they are parsed again in file order while the parts are welded
+			ForEachOBJChunk(chunks, [&](const OBJChunk& chunk) { ParseOBJChunk(chunk, attributes, nullptr); });
+
+			OBJVertexWelder welder{ maxVerticesPerPart };
+			std::vector<Mesh::Vertex_In> vertices{};
+			std::vector<uint32_t> indices{};
+			bool isValid{ true };
+
+			const auto emitCurrentPart = [&]()
+			{
+				if (indices.empty())
+					return;
+
+				welder.BuildVertices(attributes, vertices);
+				FinishOBJVertices(vertices, indices, flipAxisAndWinding);
+				emitPart(vertices, indices);
+
+				welder.Clear();
+				vertices.clear();
+				indices.clear();
+			};
+
+			for (const OBJChunk& chunk : chunks)
+			{
+				ForEachOBJLine(chunk.pBegin, chunk.pEnd, [&](OBJCommand command, const char* pCharacter, const char* pLineEnd)
+				{
+					if (command != OBJCommand::face || !isValid)
+						return;
+
+					std::array<uint32_t, 3> fileCorners[3]{};
+					std::array<uint32_t, 3> corners[3]{};
+					ParseOBJFace(pCharacter, pLineEnd, fileCorners);
+
+					if (!ResolveOBJFace(fileCorners, attributes, corners))
+					{
+						isValid = false;
+						return;
+					}
+
+					//the face has to fit in the part with all of its corners
+					if (welder.GetAmountOfVertices() + 3 > maxVerticesPerPart)
+						emitCurrentPart();
+
+					const uint32_t faceIndices[3]{ welder.Weld(corners[0]), welder.Weld(corners[1]), welder.Weld(corners[2]) };
+
+					indices.push_back(faceIndices[0]);
+					indices.push_back(flipAxisAndWinding ? faceIndices[2] : faceIndices[1]);
+					indices.push_back(flipAxisAndWinding ? faceIndices[1] : faceIndices[2]);
+				});
 			}
 
+			if (!isValid)
+			{
+				std::cout << filename << " has a face with an index that doesn't exist\n";
+				return false;
+			}
+
+			emitCurrentPart();
+
 			return true;
 		}
+
 #pragma warning(pop)
 	}
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "pch.h"
+#include "VertexCompression.h"
+
+namespace dae
+{
+	namespace VertexCompression
+	{
+		namespace
+		{
+			int16_t FloatToSnorm16(float value)
+			{
+				return static_cast<int16_t>(std::round(Clamp(value, -1.f, 1.f) * 32767.f));
+			}
+
+			//-32768 and -32767 both are -1, like the input assembler does it
+			float Snorm16ToFloat(int16_t value)
+			{
+				return std::max(value / 32767.f, -1.f);
+			}
+
+			uint16_t FloatToUnorm16(float value)
+			{
+				return static_cast<uint16_t>(std::round(Saturate(value) * 65535.f));
+			}
+
+			float Unorm16ToFloat(uint16_t value)
+			{
+				return value / 65535.f;
+			}
+
+			//a flat model has no extent along one of its axes, all of its positions quantize to 0 there
+			float QuantizePosition(float position, float boundsMin, float boundsExtent)
+			{
+				if (boundsExtent <= 0.f)
+					return 0.f;
+
+				return (position - boundsMin) / boundsExtent;
+			}
+		}
+
+		uint16_t FloatToHalf(float value)
+		{
+			uint32_t bits{};
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			const uint16_t sign{ static_cast<uint16_t>((bits >> 16) & 0x8000) };
+			const uint32_t absoluteBits{ bits & 0x7FFFFFFF };
+
+			//nan stays nan, infinity and everything too large for a half becomes infinity
+			if (absoluteBits > 0x7F800000)
+				return sign | 0x7E00;
+
+			if (absoluteBits >= 0x477FF000)
+				return sign | 0x7C00;
+
+			//too small for a normal half: shift the mantissa with its implicit 1 into a denormal, rounded to nearest even
+			if (absoluteBits < 0x38800000)
+			{
+				if (absoluteBits < 0x33000000)
+					return sign;
+
+				const uint32_t exponent{ absoluteBits >> 23 };
+				const uint32_t mantissa{ (absoluteBits & 0x007FFFFF) | 0x00800000 };
+				const uint32_t shift{ 126 - exponent };
+				const uint32_t halfMantissa{ mantissa >> shift };
+				const uint32_t remainder{ mantissa & ((1u << shift) - 1) };
+				const uint32_t halfway{ 1u << (shift - 1) };
+				const uint32_t roundUp{ remainder > halfway || (remainder == halfway && (halfMantissa & 1)) };
+
+				return sign | static_cast<uint16_t>(halfMantissa + roundUp);
+			}
+
+			//rebias the exponent from 127 to 15 and drop 13 mantissa bits, rounded to nearest even
+			//a mantissa that rounds up into the next exponent carries over into it, which is what should happen
+			const uint32_t rebiased{ absoluteBits - (112u << 23) };
+			const uint32_t roundUp{ ((rebiased & 0x1FFF) > 0x1000) || ((rebiased & 0x3FFF) == 0x3000) };
+
+			return sign | static_cast<uint16_t>((rebiased >> 13) + roundUp);
+		}
+
+		float HalfToFloat(uint16_t half)
+		{
+			const uint32_t sign{ static_cast<uint32_t>(half & 0x8000) << 16 };
+			uint32_t exponent{ (half >> 10) & 0x1F };
+			uint32_t mantissa{ half & 0x03FFu };
+			uint32_t bits{};
+
+			if (exponent == 0x1F)
+			{
+				bits = sign | 0x7F800000 | (mantissa << 13);
+			}
+			else if (exponent != 0)
+			{
+				bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+			}
+			else if (mantissa != 0)
+			{
+				//denormal half, normalize it for the float
+				exponent = 113;
+
+				while ((mantissa & 0x0400) == 0)
+				{
+					mantissa <<= 1;
+					--exponent;
+				}
+
+				bits = sign | (exponent << 23) | ((mantissa & 0x03FF) << 13);
+			}
+			else
+			{
+				bits = sign;
+			}
+
+			float value{};
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		void EncodeOctahedral(const Vector3& direction, int16_t (&encoded)[2])
+		{
+			const float manhattanLength{ std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z) };
+
+			if (manhattanLength <= 0.f)
+			{
+				encoded[0] = 0;
+				encoded[1] = 0;
+				return;
+			}
+
+			float x{ direction.x / manhattanLength };
+			float y{ direction.y / manhattanLength };
+
+			//the lower half of the octahedron is folded over the diagonals of the square
+			if (direction.z < 0.f)
+			{
+				const float foldedX{ (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f) };
+				const float foldedY{ (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f) };
+				x = foldedX;
+				y = foldedY;
+			}
+
+			encoded[0] = FloatToSnorm16(x);
+			encoded[1] = FloatToSnorm16(y);
+		}
+
+		Vector3 DecodeOctahedral(const int16_t (&encoded)[2])
+		{
+			Vector3 direction{ Snorm16ToFloat(encoded[0]), Snorm16ToFloat(encoded[1]), 0.f };
+			direction.z = 1.f - std::abs(direction.x) - std::abs(direction.y);
+
+			const float fold{ Saturate(-direction.z) };
+			direction.x += direction.x >= 0.f ? -fold : fold;
+			direction.y += direction.y >= 0.f ? -fold : fold;
+
+			return direction.Normalized();
+		}
+
+		Mesh::CompactVertex_In CompressVertex(const Mesh::Vertex_In& vertex, const Vector3& boundsMin, const Vector3& boundsExtent)
+		{
+			Mesh::CompactVertex_In compactVertex{};
+
+			compactVertex.position[0] = FloatToUnorm16(QuantizePosition(vertex.position.x, boundsMin.x, boundsExtent.x));
+			compactVertex.position[1] = FloatToUnorm16(QuantizePosition(vertex.position.y, boundsMin.y, boundsExtent.y));
+			compactVertex.position[2] = FloatToUnorm16(QuantizePosition(vertex.position.z, boundsMin.z, boundsExtent.z));
+			compactVertex.position[3] = vertex.tangentSign < 0.f ? 0 : UINT16_MAX;
+
+			compactVertex.uv[0] = FloatToHalf(vertex.uv.x);
+			compactVertex.uv[1] = FloatToHalf(vertex.uv.y);
+
+			EncodeOctahedral(vertex.normal, compactVertex.normal);
+			EncodeOctahedral(vertex.tangent, compactVertex.tangent);
+
+			return compactVertex;
+		}
+
+		Mesh::Vertex_In DecompressVertex(const Mesh::CompactVertex_In& vertex, const Vector3& boundsMin, const Vector3& boundsExtent)
+		{
+			Mesh::Vertex_In fullVertex{};
+
+			fullVertex.position =
+			{
+				boundsMin.x + Unorm16ToFloat(vertex.position[0]) * boundsExtent.x,
+				boundsMin.y + Unorm16ToFloat(vertex.position[1]) * boundsExtent.y,
+				boundsMin.z + Unorm16ToFloat(vertex.position[2]) * boundsExtent.z
+			};
+
+			fullVertex.uv = { HalfToFloat(vertex.uv[0]), HalfToFloat(vertex.uv[1]) };
+			fullVertex.normal = DecodeOctahedral(vertex.normal);
+			fullVertex.tangent = DecodeOctahedral(vertex.tangent);
+			fullVertex.tangentSign = vertex.position[3] == 0 ? -1.f : 1.f;
+
+			return fullVertex;
+		}
+	}
+}
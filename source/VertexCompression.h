@@ -0,0 +1,21 @@
+#pragma once
+#include "pch.h"
+#include "Mesh.h"
+
+namespace dae
+{
+	//conversions between Mesh::Vertex_In and the compact layout, the vertex shader of the compact technique decodes the same way
+	namespace VertexCompression
+	{
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t half);
+
+		//unit vector folded onto an octahedron and unfolded into a square, stored as two snorm16 values
+		void EncodeOctahedral(const Vector3& direction, int16_t (&encoded)[2]);
+		Vector3 DecodeOctahedral(const int16_t (&encoded)[2]);
+
+		//positions are stored as unorm16 between boundsMin and boundsMin + boundsExtent
+		Mesh::CompactVertex_In CompressVertex(const Mesh::Vertex_In& vertex, const Vector3& boundsMin, const Vector3& boundsExtent);
+		Mesh::Vertex_In DecompressVertex(const Mesh::CompactVertex_In& vertex, const Vector3& boundsMin, const Vector3& boundsExtent);
+	}
+}
@@ -6,6 +6,7 @@
 
 #undef main
 #include "Renderer.h"
+#include "RenderThread.h"
 
 using namespace dae;
 
@@ -15,12 +16,76 @@ void ShutDown(SDL_Window* pWindow)
 	SDL_Quit();
 }
 
-int main(int argc, char* args[])
+void HandleKeyUp(Renderer* pRenderer, Timer* pTimer, SDL_Scancode scancode)
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
+	if (scancode == SDL_SCANCODE_F1)
+	{
+		pRenderer->CycleRenderModes();
+	}
+
+	if (scancode == SDL_SCANCODE_F2)
+	{
+		pRenderer->ToggleIsRotating();
+	}
+
+	if (scancode == SDL_SCANCODE_F3)
+	{
+		pRenderer->ToggleFireFX();
+	}
+
+	if (scancode == SDL_SCANCODE_F4)
+	{
+		pRenderer->ChangeSamplerState();
+	}
+
+	if (scancode == SDL_SCANCODE_F5)
+	{
+		pRenderer->CycleShadingMode();
+	}
+
+	if (scancode == SDL_SCANCODE_F6)
+	{
+		pRenderer->ToggleNormalMap();
+	}
+
+	if (scancode == SDL_SCANCODE_F7)
+	{
+		pRenderer->ToggleDepthBufferVisualization();
+	}
+
+	if (scancode == SDL_SCANCODE_F8)
+	{
+		pRenderer->ToggleBoundingBoxVisualization();
+	}
+
+	if (scancode == SDL_SCANCODE_F9)
+	{
+		pRenderer->CycleCullModes();
+	}
+
+	if (scancode == SDL_SCANCODE_F10)
+	{
+		pRenderer->ToggleUseUniformClearColor();
+	}
+
+	if (scancode == SDL_SCANCODE_F11)
+	{
+		pTimer->TogglePrintFPS();
+	}
+
+	if (scancode == SDL_SCANCODE_P)
+	{
+		pRenderer->TogglePipelinedRendering();
+	}
+
+	if (scancode == SDL_SCANCODE_I)
+	{
+		pRenderer->ToggleFleet();
+	}
+}
 
+int main(int argc, char* args[])
+{
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
 
@@ -40,8 +105,63 @@ int main(int argc, char* args[])
 	const auto pTimer = new Timer();
 	const auto pRenderer = new Renderer(pWindow);
 
+	bool checkDeterminism{ false };
+	bool useRenderThread{ false };
+	bool runBenchmark{ false };
+
+	for (int index{ 1 }; index < argc; ++index)
+	{
+		const std::string argument{ args[index] };
+
+		if (argument == "--check-determinism")
+			checkDeterminism = true;
+		else if (argument == "--render-thread")
+			useRenderThread = true;
+		else if (argument == "--benchmark")
+			runBenchmark = true;
+	}
+
+	//Self-check: the software rasterizer has to give the same image for any amount of threads
+	if (checkDeterminism)
+	{
+		pTimer->Start();
+		pRenderer->Update(pTimer);
+		const bool isDeterministic{ pRenderer->CheckDeterministicSoftwareRendering() };
+
+		delete pRenderer;
+		delete pTimer;
+
+		ShutDown(pWindow);
+		return isDeterministic ? 0 : 1;
+	}
+
+	//Benchmark: frame times of the software rasterizer while the vehicle makes a full turn
+	if (runBenchmark)
+	{
+		constexpr int amountOfBenchmarkFrames{ 360 };
+
+		pTimer->Start();
+		pRenderer->Update(pTimer);
+		pRenderer->BenchmarkSoftwareRendering(amountOfBenchmarkFrames);
+
+		delete pRenderer;
+		delete pTimer;
+
+		ShutDown(pWindow);
+		return 0;
+	}
+
 	//Start loop
 	pTimer->Start();
+
+	//the render thread needs a published frame state before it can render
+	RenderThread* pRenderThread{ nullptr };
+	if (useRenderThread)
+	{
+		pRenderer->Update(pTimer);
+		pRenderThread = new RenderThread(pRenderer, [pRenderer](SDL_Scancode scancode, Timer* pRenderTimer) { HandleKeyUp(pRenderer, pRenderTimer, scancode); });
+	}
+
 	float printTimer = 0.f;
 	bool isLooping = true;
 	while (isLooping)
@@ -56,62 +176,11 @@ int main(int argc, char* args[])
 				isLooping = false;
 				break;
 			case SDL_KEYUP:
-				//Test for a key
-				//if (e.key.keysym.scancode == SDL_SCANCODE_X)
-				if (e.key.keysym.scancode == SDL_SCANCODE_F1)
-				{
-					pRenderer->CycleRenderModes();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F2)
-				{
-					pRenderer->ToggleIsRotating();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F3)
-				{
-					pRenderer->ToggleFireFX();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F4)
-				{
-					pRenderer->ChangeSamplerState();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F5)
-				{
-					pRenderer->CycleShadingMode();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F6)
-				{
-					pRenderer->ToggleNormalMap();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F7)
-				{
-					pRenderer->ToggleDepthBufferVisualization();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F8)
-				{
-					pRenderer->ToggleBoundingBoxVisualization();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F9)
-				{
-					pRenderer->CycleCullModes();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F10)
-				{
-					pRenderer->ToggleUseUniformClearColor();
-				}
-
-				if (e.key.keysym.scancode == SDL_SCANCODE_F11)
-				{
-					pTimer->TogglePrintFPS();
-				}
+				//the rotation is part of the update, everything else belongs to the thread that renders
+				if (pRenderThread && e.key.keysym.scancode != SDL_SCANCODE_F2)
+					pRenderThread->QueueKey(e.key.keysym.scancode);
+				else
+					HandleKeyUp(pRenderer, pTimer, e.key.keysym.scancode);
 				break;
 			default: ;
 			}
@@ -121,20 +190,25 @@ int main(int argc, char* args[])
 		pRenderer->Update(pTimer);
 
 		//--------- Render ---------
-		pRenderer->Render();
+		if (pRenderThread)
+			SDL_Delay(1); //the render thread picks up the update, no need to update faster than the input can change
+		else
+			pRenderer->Render();
 
 		//--------- Timer ---------
 		pTimer->Update();
 		printTimer += pTimer->GetElapsed();
-		if (printTimer >= 1.f && pTimer->GetPrintFPS())
+		if (printTimer >= 1.f && pTimer->GetPrintFPS() && !pRenderThread)
 		{
 			printTimer = 0.f;
 			std::cout << "dFPS: " << pTimer->GetdFPS() << std::endl;
+			pRenderer->PrintThreadUtilization();
 		}
 	}
 	pTimer->Stop();
 
 	//Shutdown "framework"
+	delete pRenderThread;
 	delete pRenderer;
 	delete pTimer;
 